@@ -0,0 +1,164 @@
+#!/bin/bash
+set -e
+export LLVM_INSTALL_PATH=/modules/cs325/llvm-18.1.8
+export PATH=$LLVM_INSTALL_PATH/bin:$PATH
+export LD_LIBRARY_PATH=$LLVM_INSTALL_PATH/lib:$LD_LIBRARY_PATH
+
+module load GCC/13.3.0
+
+DIR="$(pwd)"
+
+### Build mccomp compiler
+echo "Cleanup *****"
+rm -rf ./mccomp
+
+echo "Compile *****"
+
+make clean
+make -j mccomp
+
+COMP=$DIR/mccomp
+echo $COMP
+
+GEN_DIR=$DIR/ast-file-tests/gen
+
+# Compiles $1 with the remaining arguments; the IR goes to $GEN_DIR/$2.ll,
+# diagnostics to $GEN_DIR/$2.err and the exit status to $GEN_DIR/$2.rc
+function compile {
+  local src=$1 out=$2
+  shift 2
+  local rc=0
+  "$COMP" "$@" "$src" -o $GEN_DIR/$out.ll > /dev/null 2> $GEN_DIR/$out.err || rc=$?
+  echo $rc > $GEN_DIR/$out.rc
+}
+
+# Whether the two compiles $1 and $2 ended the same way: exit status,
+# diagnostics other than the note about a saved AST and, when there is any, IR
+function same_result {
+  cmp -s $GEN_DIR/$1.rc $GEN_DIR/$2.rc &&
+    cmp -s <(grep -v "not using the saved AST" $GEN_DIR/$1.err) <(grep -v "not using the saved AST" $GEN_DIR/$2.err) &&
+    { [ ! -f $GEN_DIR/$1.ll ] || cmp -s $GEN_DIR/$1.ll $GEN_DIR/$2.ll; }
+}
+
+# Every program test is compiled three ways: parsed, parsed while saving its
+# AST, and from the saved AST. All three must end the same way, and the last
+# must actually use the saved AST unless parsing failed and none was saved.
+function run_round_trip_test {
+  mkdir -p $GEN_DIR
+  echo
+  echo "round_trip: --emit-ast then --load-ast over every program test"
+  local failed=0 count=0
+  for test_dir in tests/*/ cult-tests/*/ minic-medium-tests/*/; do
+    [ -f $test_dir/driver.cpp ] || continue
+    local src=$(ls $test_dir*.c | head -n 1)
+    rm -f $GEN_DIR/*
+    compile $src parsed
+    compile $src emitted --emit-ast=$GEN_DIR/saved.ast
+    compile $src loaded --load-ast=$GEN_DIR/saved.ast
+    count=$((count + 1))
+    if [ -f $GEN_DIR/saved.ast ] && grep -q "not using the saved AST" $GEN_DIR/loaded.err; then
+      echo "  $src: the saved AST was not used"
+      failed=1
+    elif ! same_result parsed emitted || ! same_result parsed loaded; then
+      echo "  $src: the compiles ended differently"
+      failed=1
+    fi
+  done
+  if (( failed )); then
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "  $count programs"
+  echo "PASSED"
+  rm -rf $GEN_DIR
+}
+
+# A saved AST must be ignored once its source changes, even by one character
+function run_stale_test {
+  mkdir -p $GEN_DIR
+  echo
+  echo "stale: --load-ast after the source has changed"
+  cp tests/factorial/factorial.c $GEN_DIR/stale.c
+  compile $GEN_DIR/stale.c emitted --emit-ast=$GEN_DIR/saved.ast
+  sed -i 's/i = 1;/i = 2;/' $GEN_DIR/stale.c
+  compile $GEN_DIR/stale.c parsed
+  compile $GEN_DIR/stale.c loaded --load-ast=$GEN_DIR/saved.ast
+  if ! grep -q "is stale" $GEN_DIR/loaded.err; then
+    echo "  the stale AST was used"
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  if ! cmp -s $GEN_DIR/parsed.ll $GEN_DIR/loaded.ll; then
+    echo "  the fallback parse produced different IR"
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "PASSED"
+  rm -rf $GEN_DIR
+}
+
+# Changes every byte of a saved AST in turn, flipping its lowest and then its
+# highest bit. Each load must either use the file or reject it as corrupt and
+# parse the source instead; mccomp must never crash on it.
+function run_corrupt_test {
+  mkdir -p $GEN_DIR
+  echo
+  echo "corrupt: --load-ast after single bytes of the saved AST are changed"
+  cp tests/factorial/factorial.c $GEN_DIR/corrupt.c
+  compile $GEN_DIR/corrupt.c parsed --emit-ast=$GEN_DIR/saved.ast
+  local size=$(wc -c < $GEN_DIR/saved.ast) failed=0 rejected=0
+  for (( offset = 0; offset < size; offset++ )); do
+    local byte=$(od -An -tu1 -j $offset -N 1 $GEN_DIR/saved.ast)
+    for flip in 1 128; do
+      cp $GEN_DIR/saved.ast $GEN_DIR/corrupt.ast
+      printf "\\$(printf %03o $(( byte ^ flip )))" |
+        dd of=$GEN_DIR/corrupt.ast bs=1 seek=$offset conv=notrunc status=none
+      compile $GEN_DIR/corrupt.c loaded --load-ast=$GEN_DIR/corrupt.ast
+      if (( $(cat $GEN_DIR/loaded.rc) > 1 )); then
+        echo "  byte $offset ^ $flip: mccomp exited $(cat $GEN_DIR/loaded.rc)"
+        failed=1
+      elif grep -q "is corrupt" $GEN_DIR/loaded.err; then
+        rejected=$((rejected + 1))
+        if ! cmp -s $GEN_DIR/parsed.ll $GEN_DIR/loaded.ll; then
+          echo "  byte $offset ^ $flip: the fallback parse produced different IR"
+          failed=1
+        fi
+      fi
+    done
+  done
+  if (( failed )); then
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "  $((size * 2)) changes, $rejected rejected as corrupt"
+  echo "PASSED"
+  rm -rf $GEN_DIR
+}
+
+function list_options {
+  echo "Select a test to run:"
+  echo "1) round_trip (every program in tests/, cult-tests/ and minic-medium-tests/)"
+  echo "2) stale (changed source)"
+  echo "3) corrupt (every byte of a saved AST changed in turn)"
+  echo "4) Run all tests"
+  echo "q) Quit"
+}
+
+function run_all_tests {
+  run_round_trip_test
+  run_stale_test
+  run_corrupt_test
+}
+
+while true; do
+  list_options
+  read -p "Enter your choice: " choice
+  case $choice in
+    1) run_round_trip_test ;;
+    2) run_stale_test ;;
+    3) run_corrupt_test ;;
+    4) run_all_tests ;;
+    q) echo "Exiting."; exit 0 ;;
+    *) echo "Invalid choice. Please try again." ;;
+  esac
+done
@@ -0,0 +1,172 @@
+// AST allocation benchmark: heap traffic, arena usage and peak RSS of parsing.
+//
+// Usage: ./ast_alloc_bench [file.c ...]
+//
+// Each input is lexed into a TokenStream and then parsed once by the
+// recursive-descent parser into a fresh ASTArena. Global operator new is
+// replaced to count the heap allocations made while parsing and while freeing
+// the tree; the arena's own node, array and byte counts are reported next to
+// them. Every input runs in its own child process so its peak RSS can be read
+// back with wait4(). With no files a synthetic program of 100k small functions
+// is generated; to run over the test corpus pass its sources, e.g.
+// ./ast_alloc_bench tests/*/*.c cult-tests/*/*.c
+#include "lexer.h"
+#include "parser.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static size_t HeapAllocations = 0;
+static size_t HeapBytes = 0;
+
+void *operator new(size_t size) {
+    ++HeapAllocations;
+    HeapBytes += size;
+    if (void *ptr = malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *ptr) noexcept { free(ptr); }
+void operator delete[](void *ptr) noexcept { free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { free(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { free(ptr); }
+
+static std::string generateProgram(int functions) {
+    std::string src = "extern int print_int(int X);\n";
+    for (int fn = 0; fn < functions; ++fn) {
+        std::string n = std::to_string(fn);
+        src += "int f" + n + "(int a, float b) {\n";
+        src += "    int i;\n    float acc;\n    i = 0;\n    acc = 0.0;\n";
+        src += "    while (i < a) {\n";
+        src += "        if ((i % 3) == 0 && acc <= b * 2.5) { acc = acc + print_int(i); } else { acc = acc - (b / 4.0); }\n";
+        src += "        i = i + 1;\n    }\n    return i;\n}\n";
+    }
+    src += "int main() {\n    return f" + std::to_string(functions - 1) + "(10, 1.5);\n}\n";
+    return src;
+}
+
+struct AllocResult {
+    size_t tokens = 0;
+    size_t parseAllocations = 0;
+    size_t parseBytes = 0;
+    size_t freeAllocations = 0;
+    size_t arenaNodes = 0;
+    size_t arenaArrays = 0;
+    size_t arenaBytes = 0;
+    double parseSeconds = 0;
+    double freeSeconds = 0;
+};
+
+static AllocResult measure(unsigned bufferId) {
+    AllocResult result;
+    TokenStream tokens = lexAll(bufferId);
+    result.tokens = tokens.size();
+    usePrelexedTokens(&tokens);
+
+    auto *arena = new ASTArena;
+    CurrentArena = arena;
+    size_t allocations = HeapAllocations, bytes = HeapBytes;
+    auto start = std::chrono::steady_clock::now();
+    getNextToken();
+    if (!parseProgram()) {
+        fprintf(stderr, "parse failed\n");
+        exit(1);
+    }
+    auto parsed = std::chrono::steady_clock::now();
+    result.parseSeconds = std::chrono::duration<double>(parsed - start).count();
+    result.parseAllocations = HeapAllocations - allocations;
+    result.parseBytes = HeapBytes - bytes;
+    result.arenaNodes = arena->nodeCount();
+    result.arenaArrays = arena->arrayCount();
+    result.arenaBytes = arena->bytesAllocated();
+
+    allocations = HeapAllocations;
+    start = std::chrono::steady_clock::now();
+    delete arena;
+    result.freeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.freeAllocations = HeapAllocations - allocations;
+    CurrentArena = nullptr;
+    return result;
+}
+
+int main(int argc, char **argv) {
+    std::vector<unsigned> bufferIds;
+    for (int i = 1; i < argc; ++i) {
+        std::error_code EC;
+        unsigned bufferId = loadSourceFile(argv[i], EC);
+        if (!bufferId) {
+            fprintf(stderr, "%s: %s\n", argv[i], EC.message().c_str());
+            return 1;
+        }
+        bufferIds.push_back(bufferId);
+    }
+    if (bufferIds.empty()) {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateProgram(100000), "<synthetic>");
+        bufferIds.push_back(SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc()));
+    }
+
+    printf("%-40s %9s %11s %10s %9s %9s %9s %9s %9s\n", "input", "tokens", "heap allocs", "heap MB",
+           "nodes", "arena MB", "parse ms", "free ms", "RSS MB");
+    AllocResult total;
+    for (unsigned bufferId : bufferIds) {
+        std::string name = SrcMgr.getMemoryBuffer(bufferId)->getBufferIdentifier().str();
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            AllocResult result = measure(bufferId);
+            if (write(fds[1], &result, sizeof(result)) != sizeof(result))
+                _exit(1);
+            _exit(0);
+        }
+        close(fds[1]);
+
+        AllocResult result;
+        bool received = read(fds[0], &result, sizeof(result)) == sizeof(result);
+        close(fds[0]);
+        int status = 0;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s: run failed\n", name.c_str());
+            return 1;
+        }
+
+        printf("%-40s %9zu %11zu %10.2f %9zu %9.2f %9.2f %9.2f %9.1f\n", name.c_str(), result.tokens,
+               result.parseAllocations, result.parseBytes / 1e6, result.arenaNodes, result.arenaBytes / 1e6,
+               result.parseSeconds * 1e3, result.freeSeconds * 1e3, usage.ru_maxrss / 1024.0);
+        if (result.freeAllocations)
+            printf("  (%zu heap allocations while freeing the tree)\n", result.freeAllocations);
+        total.tokens += result.tokens;
+        total.parseAllocations += result.parseAllocations;
+        total.parseBytes += result.parseBytes;
+        total.arenaNodes += result.arenaNodes;
+        total.arenaArrays += result.arenaArrays;
+        total.arenaBytes += result.arenaBytes;
+        total.parseSeconds += result.parseSeconds;
+        total.freeSeconds += result.freeSeconds;
+    }
+
+    if (bufferIds.size() > 1)
+        printf("%-40s %9zu %11zu %10.2f %9zu %9.2f %9.2f %9.2f\n", "total", total.tokens,
+               total.parseAllocations, total.parseBytes / 1e6, total.arenaNodes, total.arenaBytes / 1e6,
+               total.parseSeconds * 1e3, total.freeSeconds * 1e3);
+    printf("heap allocations per AST node: %.3f, arena arrays: %zu\n",
+           total.arenaNodes ? double(total.parseAllocations) / total.arenaNodes : 0.0, total.arenaArrays);
+    return 0;
+}
@@ -0,0 +1,142 @@
+// Module hand-off microbenchmark: textual IR against bitcode.
+//
+// Usage: ./bitcode_bench [-n iterations] [-f functions]
+//
+// Generates a MiniC program of many functions with loops, branches and calls,
+// compiles it once with compileModule() (compiler.h), and then times, in
+// memory, the ways the module can reach another tool:
+//   .ll          - Module::print, and parseAssembly into a fresh context;
+//   .bc          - WriteBitcodeToFile, and parseBitcodeFile;
+//   .bc+summary  - the same with the module summary index built and written;
+// and compileModule() itself, which hands the module over with no
+// serialization at all. Every module read back must have as many instructions
+// as the original.
+#include "compiler.h"
+#include "output.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+static std::string generateProgram(int functions) {
+    std::string src;
+    for (int f = 0; f < functions; ++f) {
+        std::string n = std::to_string(f);
+        src += "int f" + n + "(int n, float x) {\n"
+               "    int i; int acc; float y;\n"
+               "    i = 0; acc = " + n + "; y = x;\n"
+               "    while (i < n) {\n"
+               "        if (i % 3 == 0 && acc > -1000) { acc = acc + i * " + n + " - (acc / 7); }\n"
+               "        else { y = y * 1.5 - acc; acc = acc - 1; }\n"
+               "        i = i + 1;\n"
+               "    }\n";
+        src += f ? "    return acc + f" + std::to_string(f - 1) + "(n - 1, y);\n}\n" : "    return acc;\n}\n";
+    }
+    return src;
+}
+
+static size_t countInstructions(const llvm::Module& module) {
+    size_t count = 0;
+    for (const llvm::Function& function : module)
+        count += function.getInstructionCount();
+    return count;
+}
+
+template <typename Fn>
+static double timeIterations(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static void fail(const char* what) {
+    fprintf(stderr, "%s\n", what);
+    exit(1);
+}
+
+int main(int argc, char** argv) {
+    int iterations = 10;
+    int functions = 20000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-n"))
+            iterations = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-f"))
+            functions = atoi(argv[i + 1]);
+    }
+
+    // compileModule() reads a file, as mccomp does
+    llvm::SmallString<128> sourcePath;
+    int fd;
+    if (llvm::sys::fs::createTemporaryFile("bitcode_bench", "c", fd, sourcePath))
+        fail("could not create the source file");
+    {
+        llvm::raw_fd_ostream source(fd, true);
+        source << generateProgram(functions);
+    }
+    std::string error;
+    std::unique_ptr<llvm::Module> module;
+    double compile = timeIterations(1, [&] { module = compileModule(sourcePath.c_str(), CompileOptions(), error); });
+    llvm::sys::fs::remove(sourcePath);
+    if (!module)
+        fail(error.c_str());
+    size_t instructions = countInstructions(*module);
+
+    struct Format {
+        const char* name;
+        bool bitcode;
+        bool summary;
+    };
+    const Format formats[] = {{".ll", false, false}, {".bc", true, false}, {".bc+summary", true, true}};
+
+    printf("%d functions, %zu instructions; compileModule() %.1f ms, handing over the module itself\n\n",
+           functions, instructions, compile * 1e3);
+    printf("%-12s %10s %12s %12s %14s\n", "format", "size", "write ms", "read ms", "vs .ll (w+r)");
+    double textTotal = 0;
+    for (const Format& format : formats) {
+        llvm::SmallVector<char, 0> buffer;
+        double write = timeIterations(iterations, [&] {
+            buffer.clear();
+            llvm::raw_svector_ostream os(buffer);
+            if (format.bitcode)
+                writeBitcode(*module, os, format.summary);
+            else
+                module->print(os, nullptr);
+        });
+
+        llvm::MemoryBufferRef input(llvm::StringRef(buffer.data(), buffer.size()), "bench");
+        double read = timeIterations(iterations, [&] {
+            llvm::LLVMContext context;
+            std::unique_ptr<llvm::Module> copy;
+            if (format.bitcode) {
+                llvm::Expected<std::unique_ptr<llvm::Module>> parsed = llvm::parseBitcodeFile(input, context);
+                if (!parsed)
+                    fail(llvm::toString(parsed.takeError()).c_str());
+                copy = std::move(*parsed);
+            } else {
+                llvm::SMDiagnostic diagnostic;
+                copy = llvm::parseAssembly(input, diagnostic, context);
+                if (!copy)
+                    fail(diagnostic.getMessage().str().c_str());
+            }
+            if (countInstructions(*copy) != instructions)
+                fail("the module read back differs");
+        });
+
+        if (!format.bitcode)
+            textTotal = write + read;
+        printf("%-12s %7.2f MB %12.2f %12.2f %13.2fx\n", format.name, buffer.size() / 1e6, write * 1e3, read * 1e3,
+               textTotal / (write + read));
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+// Expression parsing microbenchmark.
+//
+// Usage: ./expr_bench [-n iterations] [file.c]
+//
+// Lexes the input once into a TokenStream, then parses it repeatedly from the
+// stream so the timing covers the parser alone. With no file it generates a
+// program of long arithmetic and logical expressions that exercise every
+// precedence level, parenthesised subexpressions and unary chains.
+#include "lexer.h"
+#include "parser.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+static std::string generateExpression(std::mt19937 &rng, int depth) {
+    static const char *const operators[] = {"||", "&&", "==", "!=", "<", "<=", ">",
+                                            ">=", "+",  "-",  "*",  "/",  "%"};
+    static const char *const leaves[] = {"a", "b", "c", "1", "2.5", "true", "g(a, b)"};
+    unsigned r = rng() % 100;
+    if (depth == 0 || r < 15)
+        return leaves[rng() % 7];
+    if (r < 25)
+        return std::string(rng() % 2 ? "-" : "!") + generateExpression(rng, depth - 1);
+    if (r < 35)
+        return "(" + generateExpression(rng, depth - 1) + ")";
+    return generateExpression(rng, depth - 1) + " " + operators[rng() % 13] + " " +
+           generateExpression(rng, depth - 1);
+}
+
+static std::string generateProgram(size_t targetBytes) {
+    std::mt19937 rng(325);
+    std::string src = "int g(int x, int y) { return x; }\n";
+    int fn = 0;
+    for (; src.size() < targetBytes; ++fn) {
+        src += "int f" + std::to_string(fn) + "(int a, int b) {\n    int c;\n";
+        for (int stmt = 0; stmt < 32; ++stmt)
+            src += "    c = " + generateExpression(rng, 7) + ";\n";
+        src += "    return c;\n}\n";
+    }
+    src += "int main() {\n    return f0(1, 2);\n}\n";
+    return src;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 10;
+    const char *file = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+            file = argv[i];
+    }
+
+    unsigned bufferId;
+    if (file) {
+        std::error_code EC;
+        bufferId = loadSourceFile(file, EC);
+        if (!bufferId) {
+            fprintf(stderr, "%s: %s\n", file, EC.message().c_str());
+            return 1;
+        }
+    } else {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateProgram(4 << 20), "<synthetic>");
+        bufferId = SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    }
+    const llvm::MemoryBuffer *buffer = SrcMgr.getMemoryBuffer(bufferId);
+    double megabytes = buffer->getBufferSize() / 1e6;
+
+    TokenStream tokens = lexAll(bufferId);
+    size_t operators = 0;
+    for (int16_t type : tokens.types)
+        operators += type == OR || type == AND || type == EQ || type == NE || type == LT ||
+                     type == LE || type == GT || type == GE || type == PLUS || type == MINUS ||
+                     type == ASTERIX || type == DIV || type == MOD || type == NOT;
+    printf("%s: %.2f MB, %zu tokens, %zu operator tokens, %d iterations\n",
+           buffer->getBufferIdentifier().str().c_str(), megabytes, tokens.size(), operators,
+           iterations);
+
+    double seconds = 0;
+    for (int i = 0; i < iterations; ++i) {
+        usePrelexedTokens(&tokens);
+        auto start = std::chrono::steady_clock::now();
+        ASTArena arena;
+        CurrentArena = &arena;
+        getNextToken();
+        auto program = parseProgram();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!program) {
+            fprintf(stderr, "parse failed\n");
+            return 1;
+        }
+    }
+
+    double perIteration = seconds / iterations;
+    printf("  parse: %8.2f ms/iteration %9.1f MB/s %12.0f tokens/s %8.1f ns/operator\n",
+           perIteration * 1e3, megabytes / perIteration, tokens.size() / perIteration,
+           perIteration * 1e9 / operators);
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Tree versus flattened AST benchmark: memory, whole-tree walks and codegen.
+//
+// Usage: ./flat_ast_bench [-n iterations] [file.c ...]
+//
+// Each input is parsed once by the recursive-descent parser, flattened once
+// (flat_ast.h) and both forms are checked by sema. Reported per input: node count, the bytes the tree takes in its
+// arena against the bytes of the flat arrays, the time to flatten, the time to
+// count nodes by kind with a RecursiveASTVisitor over the tree against a scan of
+// the flat array, and the time of code generation from each form. Before timing,
+// the two walks' counts and the two modules' IR are compared. The inputs must
+// therefore be valid programs; with no files a synthetic program of small
+// functions is generated. To run over the test corpus pass its sources, e.g.
+// ./flat_ast_bench tests/*/*.c cult-tests/*/*.c
+#include "ast_visitor.h"
+#include "codegen.h"
+#include "flat_ast.h"
+#include "lexer.h"
+#include "llvm_context.h"
+#include "parser.h"
+#include "sema.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string generateProgram(int functions) {
+    std::string src = "extern int print_int(int X);\n";
+    for (int fn = 0; fn < functions; ++fn) {
+        std::string n = std::to_string(fn);
+        src += "int f" + n + "(int a, float b) {\n";
+        src += "    int i;\n    float acc;\n    i = 0;\n    acc = 0.0;\n";
+        src += "    while (i < a) {\n";
+        src += "        if ((i % 3) == 0 && acc <= b * 2.5) { acc = acc + print_int(i); } else { acc = acc - (b / 4.0); }\n";
+        src += "        i = i + 1;\n    }\n    return i;\n}\n";
+    }
+    src += "int main() {\n    return f" + std::to_string(functions - 1) + "(10, 1.5);\n}\n";
+    return src;
+}
+
+using KindCounts = std::array<size_t, NumASTKinds>;
+
+class TreeKindCounter : public RecursiveASTVisitor<TreeKindCounter> {
+public:
+    KindCounts counts{};
+
+    bool traverse(ASTnode* node) {
+        if (node)
+            ++counts[size_t(node->getKind())];
+        return RecursiveASTVisitor::traverse(node);
+    }
+};
+
+static KindCounts countKinds(ASTnode* root) {
+    TreeKindCounter counter;
+    counter.traverse(root);
+    return counter.counts;
+}
+
+static KindCounts countKinds(const FlatAST& ast) {
+    KindCounts counts{};
+    for (const FlatNode& node : ast.nodes)
+        ++counts[size_t(node.kind)];
+    return counts;
+}
+
+// Starts an empty module, as mccomp does
+static void resetModule() {
+    TheModule = std::make_unique<Module>("mini-c", TheContext);
+}
+
+static std::string printModule() {
+    std::string ir;
+    llvm::raw_string_ostream os(ir);
+    TheModule->print(os, nullptr);
+    return os.str();
+}
+
+template <typename Fn>
+static double timeIterations(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+template <typename AST>
+static double timeCodegen(const AST& ast, int iterations) {
+    double seconds = 0;
+    for (int i = 0; i < iterations; ++i) {
+        resetModule();
+        auto start = std::chrono::steady_clock::now();
+        codegen(ast);
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return seconds / iterations;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 10;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+            files.push_back(argv[i]);
+    }
+
+    std::vector<unsigned> bufferIds;
+    for (const char *file : files) {
+        std::error_code EC;
+        unsigned bufferId = loadSourceFile(file, EC);
+        if (!bufferId) {
+            fprintf(stderr, "%s: %s\n", file, EC.message().c_str());
+            return 1;
+        }
+        bufferIds.push_back(bufferId);
+    }
+    if (files.empty()) {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateProgram(20000), "<synthetic>");
+        bufferIds.push_back(SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc()));
+    }
+
+    printf("%-40s %9s %9s %9s %10s %10s %10s %10s %10s\n", "input", "nodes", "tree MB", "flat MB",
+           "flatten ms", "tree walk", "flat walk", "tree cg ms", "flat cg ms");
+    for (unsigned bufferId : bufferIds) {
+        std::string name = SrcMgr.getMemoryBuffer(bufferId)->getBufferIdentifier().str();
+        TokenStream tokens = lexAll(bufferId);
+        usePrelexedTokens(&tokens);
+        ASTArena arena;
+        CurrentArena = &arena;
+        getNextToken();
+        ASTnode *tree = parseProgram();
+        if (!tree) {
+            fprintf(stderr, "%s: parse failed\n", name.c_str());
+            return 1;
+        }
+
+        double flattenSeconds = timeIterations(iterations, [&] { flattenAST(tree); });
+        FlatAST flat = flattenAST(tree);
+        sema(tree);
+        sema(flat);
+        if (countKinds(tree) != countKinds(flat)) {
+            fprintf(stderr, "%s: the flat AST has different nodes\n", name.c_str());
+            return 1;
+        }
+        resetModule();
+        codegen(tree);
+        std::string treeIR = printModule();
+        resetModule();
+        codegen(flat);
+        if (printModule() != treeIR) {
+            fprintf(stderr, "%s: the two forms generated different IR\n", name.c_str());
+            return 1;
+        }
+
+        size_t sink = 0;
+        double treeWalk = timeIterations(iterations, [&] { sink += countKinds(tree)[0]; });
+        double flatWalk = timeIterations(iterations, [&] { sink += countKinds(flat)[0]; });
+        double treeCodegen = timeCodegen(tree, iterations);
+        double flatCodegen = timeCodegen(flat, iterations);
+        printf("%-40s %9zu %9.2f %9.2f %10.3f %10.3f %10.3f %10.3f %10.3f\n", name.c_str(), flat.nodes.size(),
+               arena.bytesAllocated() / 1e6, flat.bytes() / 1e6, flattenSeconds * 1e3, treeWalk * 1e3,
+               flatWalk * 1e3, treeCodegen * 1e3, flatCodegen * 1e3);
+        if (sink == 0)
+            printf("  (empty program)\n");
+    }
+    return 0;
+}
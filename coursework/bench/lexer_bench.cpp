@@ -0,0 +1,110 @@
+// Lexer throughput benchmark.
+//
+// Usage: ./lexer_bench [-n iterations] [file.c ...]
+//
+// Lexes each input with every scanning kernel set the CPU supports and reports
+// MB/s and tokens/s. With no files it generates a synthetic input shaped like
+// our generated sources: deep indentation, // comment banners and long identifiers.
+#include "lexer.h"
+#include "simd_scan.h"
+#include "source_buffer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string generateSource(size_t targetBytes) {
+    std::string src;
+    src.reserve(targetBytes + 4096);
+    for (int fn = 0; src.size() < targetBytes; ++fn) {
+        src += "// ==================================================================\n";
+        src += "// generated function " + std::to_string(fn) + "\n";
+        src += "// ==================================================================\n";
+        src += "int generated_function_with_a_long_name_" + std::to_string(fn) +
+               "(int first_parameter_value, float second_parameter_value) {\n";
+        src += "        int accumulated_intermediate_result_" + std::to_string(fn) + ";\n";
+        for (int stmt = 0; stmt < 16; ++stmt) {
+            src += "                accumulated_intermediate_result_" + std::to_string(fn) +
+                   " = first_parameter_value * " + std::to_string(1000003 * stmt + fn) +
+                   " + second_parameter_value / 12345.6789;  // keep the running value\n";
+        }
+        src += "        return accumulated_intermediate_result_" + std::to_string(fn) + ";\n}\n\n";
+    }
+    return src;
+}
+
+struct LexStats {
+    size_t tokens = 0;
+    unsigned long checksum = 0;
+    double seconds = 0;
+};
+
+static LexStats lexBuffer(unsigned bufferId, ScanISA isa, int iterations) {
+    LexStats stats;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        initLexer(bufferId, isa);
+        for (TOKEN tok = gettok(); tok.type != EOF_TOK; tok = gettok()) {
+            ++stats.tokens;
+            stats.checksum = stats.checksum * 31 + tok.srcLoc.offset + tok.lexeme.size() + tok.type;
+        }
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.tokens /= iterations;
+    return stats;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 20;
+    std::vector<unsigned> buffers;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+            continue;
+        }
+        std::error_code EC;
+        unsigned id = loadSourceFile(argv[i], EC);
+        if (!id) {
+            fprintf(stderr, "%s: %s\n", argv[i], EC.message().c_str());
+            return 1;
+        }
+        buffers.push_back(id);
+    }
+    if (buffers.empty()) {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateSource(8 << 20), "<synthetic>");
+        buffers.push_back(SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc()));
+    }
+
+    const ScanISA isas[] = {ScanISA::Scalar, ScanISA::SSE2, ScanISA::AVX2};
+    for (unsigned id : buffers) {
+        const llvm::MemoryBuffer *buffer = SrcMgr.getMemoryBuffer(id);
+        double megabytes = buffer->getBufferSize() / 1e6;
+        printf("%s: %.2f MB, %d iterations\n", buffer->getBufferIdentifier().str().c_str(),
+               megabytes, iterations);
+
+        LexStats baseline;
+        for (ScanISA isa : isas) {
+            const ScanKernels &kernels = getScanKernels(isa);
+            if (isa != ScanISA::Scalar && &kernels == &getScanKernels(ScanISA::Scalar))
+                continue; // not supported on this CPU
+            if (isa == ScanISA::AVX2 && &kernels == &getScanKernels(ScanISA::SSE2))
+                continue;
+
+            LexStats stats = lexBuffer(id, isa, iterations);
+            if (isa == ScanISA::Scalar)
+                baseline = stats;
+            else if (stats.tokens != baseline.tokens || stats.checksum != baseline.checksum) {
+                fprintf(stderr, "  %s kernels disagree with scalar lexing\n", kernels.name);
+                return 1;
+            }
+            double perIteration = stats.seconds / iterations;
+            printf("  %-7s %9.1f MB/s %12.0f tokens/s  (%zu tokens, %.2fx scalar)\n", kernels.name,
+                   megabytes / perIteration, stats.tokens / perIteration, stats.tokens,
+                   baseline.seconds / stats.seconds);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,118 @@
+// Recursive-descent versus table-driven LL(1) parser benchmark.
+//
+// Usage: ./ll1_bench [-n iterations] [file.c ...]
+//
+// Each input is lexed once into a TokenStream and then parsed repeatedly from
+// it by both parsers, so the timing covers the parsers alone. Before timing,
+// the two ASTs are dumped and compared. With no files a synthetic program of
+// nested statements and expressions is generated; to run over the test corpus
+// pass its sources, e.g. ./ll1_bench tests/*/*.c cult-tests/*/*.c
+#include "lexer.h"
+#include "ll1_parser.h"
+#include "parser.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string generateProgram(size_t targetBytes) {
+    std::string src = "extern int print_int(int X);\n";
+    int fn = 0;
+    for (; src.size() < targetBytes; ++fn) {
+        std::string n = std::to_string(fn);
+        src += "int f" + n + "(int a, float b, bool c) {\n";
+        src += "    int i;\n    float acc;\n    i = 0;\n    acc = 0.0;\n";
+        src += "    while (i < a && !c) {\n";
+        for (int stmt = 0; stmt < 16; ++stmt) {
+            std::string k = std::to_string(stmt + 1);
+            src += "        if ((i % " + k + ") == 0 || acc >= -b * " + k + ".5) { acc = acc + print_int(i * " +
+                   k + ", a - " + k + "); } else { acc = acc - (b / (" + k + ".0 + acc)); }\n";
+        }
+        src += "        i = i + 1;\n    }\n    return i;\n}\n";
+    }
+    src += "int main() {\n    return f" + std::to_string(fn - 1) + "(10, 1.5, false);\n}\n";
+    return src;
+}
+
+// Parses tokens iterations times with the chosen parser and returns the total seconds
+static double timeParser(const TokenStream &tokens, bool ll1, int iterations) {
+    double seconds = 0;
+    for (int i = 0; i < iterations; ++i) {
+        usePrelexedTokens(&tokens);
+        auto start = std::chrono::steady_clock::now();
+        ASTArena arena;
+        CurrentArena = &arena;
+        getNextToken();
+        ASTnode *program = ll1 ? parseProgramLL1() : parseProgram();
+        seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (!program) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+    }
+    return seconds;
+}
+
+static std::string dumpAST(const TokenStream &tokens, bool ll1) {
+    usePrelexedTokens(&tokens);
+    ASTArena arena;
+    CurrentArena = &arena;
+    getNextToken();
+    ASTnode *program = ll1 ? parseProgramLL1() : parseProgram();
+    return to_string(program);
+}
+
+int main(int argc, char **argv) {
+    int iterations = 10;
+    std::vector<const char *> files;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else
+            files.push_back(argv[i]);
+    }
+
+    std::vector<unsigned> bufferIds;
+    for (const char *file : files) {
+        std::error_code EC;
+        unsigned bufferId = loadSourceFile(file, EC);
+        if (!bufferId) {
+            fprintf(stderr, "%s: %s\n", file, EC.message().c_str());
+            return 1;
+        }
+        bufferIds.push_back(bufferId);
+    }
+    if (files.empty()) {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateProgram(4 << 20), "<synthetic>");
+        bufferIds.push_back(SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc()));
+    }
+
+    printf("%-40s %10s %12s %12s %8s\n", "input", "tokens", "rd ms/iter", "ll1 ms/iter", "ll1/rd");
+    size_t totalTokens = 0;
+    double totalRD = 0, totalLL1 = 0;
+    for (unsigned bufferId : bufferIds) {
+        std::string name = SrcMgr.getMemoryBuffer(bufferId)->getBufferIdentifier().str();
+        TokenStream tokens = lexAll(bufferId);
+        if (dumpAST(tokens, false) != dumpAST(tokens, true)) {
+            fprintf(stderr, "%s: the two parsers built different ASTs\n", name.c_str());
+            return 1;
+        }
+
+        double rd = timeParser(tokens, false, iterations) / iterations;
+        double ll1 = timeParser(tokens, true, iterations) / iterations;
+        printf("%-40s %10zu %12.3f %12.3f %8.2f\n", name.c_str(), tokens.size(), rd * 1e3, ll1 * 1e3, ll1 / rd);
+        totalTokens += tokens.size();
+        totalRD += rd;
+        totalLL1 += ll1;
+    }
+
+    if (bufferIds.size() > 1)
+        printf("%-40s %10zu %12.3f %12.3f %8.2f\n", "total", totalTokens, totalRD * 1e3, totalLL1 * 1e3,
+               totalLL1 / totalRD);
+    printf("tokens/s: rd %.0f, ll1 %.0f\n", totalTokens / totalRD, totalTokens / totalLL1);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#!/bin/bash
+# Run time of the programs in tests/ at each -O level of mccomp.
+#
+# Usage: ./bench/opt_level_bench.sh [runs]
+#
+# Run from the coursework directory after make mccomp. Each program is
+# compiled by mccomp at -O0, -O1, -O2, -O3 and -Os. Its code generator runs at
+# the same level every time, so the columns differ only in mccomp's pipeline.
+# mccomp links the program with the test's driver, compiled with main renamed,
+# and with opt_level_main.cpp, and the result is run the given number of times
+# (10000 by default). The table gives the mean time of one run in nanoseconds,
+# which includes the driver's own checking and printing, and the speedup of -O2
+# over -O0.
+set -e
+export LLVM_INSTALL_PATH=${LLVM_INSTALL_PATH:-/modules/cs325/llvm-18.1.8}
+CXX=${CXX:-$LLVM_INSTALL_PATH/bin/clang++}
+
+DIR="$(pwd)"
+COMP=${COMP:-$DIR/mccomp}
+RUNS=${1:-10000}
+LEVELS="O0 O1 O2 O3 Os"
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+$CXX -O2 -c bench/opt_level_main.cpp -o "$WORK/main.o"
+
+printf "%-12s" "program"
+for level in $LEVELS; do printf "%10s" "-$level"; done
+printf "%9s\n" "O2/O0"
+
+for test_dir in tests/*/; do
+  name=$(basename "$test_dir")
+  [ -f "$test_dir/$name.c" ] || continue
+  $CXX -O0 -w -c -Dmain=driver_main "$test_dir/driver.cpp" -o "$WORK/driver.o"
+  printf "%-12s" "$name"
+  for level in $LEVELS; do
+    "$COMP" -$level --link="$WORK/main.o" --link="$WORK/driver.o" -o "$WORK/$name" "$test_dir/$name.c"
+    ns=$("$WORK/$name" -n "$RUNS")
+    [ $level == O0 ] && base=$ns
+    [ $level == O2 ] && o2=$ns
+    printf "%10s" "$ns"
+  done
+  awk -v a="$base" -v b="$o2" 'BEGIN { printf "%8.2fx\n", a / b }'
+done
@@ -0,0 +1,38 @@
+// Timing loop for opt_level_bench.sh.
+//
+// Usage: ./program [-n runs]
+//
+// A test's driver.cpp is compiled with -Dmain=driver_main and linked with this
+// file and the test program, so the driver, which calls the program and checks
+// its result, can run many times in one process. Whatever it prints goes to
+// /dev/null while it is timed. Prints the mean time of one run in nanoseconds,
+// from the fastest of five batches of runs.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+int driver_main();
+
+int main(int argc, char** argv) {
+    int runs = 10000;
+    if (argc == 3 && !strcmp(argv[1], "-n"))
+        runs = atoi(argv[2]);
+
+    int out = dup(STDOUT_FILENO);
+    if (out < 0 || !freopen("/dev/null", "w", stdout) || !freopen("/dev/null", "w", stderr))
+        return 1;
+    driver_main(); // warm up
+    double best = 0;
+    for (int batch = 0; batch < 5; ++batch) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < runs; ++i)
+            driver_main();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (batch == 0 || seconds < best)
+            best = seconds;
+    }
+    dprintf(out, "%.1f\n", best / runs * 1e9);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Lexing + parsing benchmark: streaming lexer versus the pre-lexed token stream.
+//
+// Usage: ./parser_bench [-n iterations] [-j jobs] [file.c]
+//
+// With -j the pre-lexed stream is also parsed by parseProgramParallel() on that
+// many threads; its time includes the serial lexing and declaration split.
+//
+// Each mode runs in its own child process so that its peak RSS can be read back
+// with wait4() without the other mode's allocations inflating it. With no file a
+// synthetic program of many small functions is generated.
+#include "lexer.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static std::string generateProgram(size_t targetBytes) {
+    std::string src = "extern int print_int(int X);\n";
+    int fn = 0;
+    for (; src.size() < targetBytes; ++fn) {
+        std::string n = std::to_string(fn);
+        src += "int f" + n + "(int a, float b) {\n";
+        src += "    int i;\n    float acc;\n    i = 0;\n    acc = 0.0;\n";
+        src += "    while (i < a) {\n";
+        for (int stmt = 0; stmt < 24; ++stmt) {
+            std::string k = std::to_string(stmt + 1);
+            src += "        if ((i % " + k + ") == 0 && acc <= b * " + k + ".5) { acc = acc + i * " + k +
+                   "; } else { acc = acc - (b / " + k + ".0); }\n";
+        }
+        src += "        i = i + 1;\n    }\n    return i;\n}\n";
+    }
+    src += "int main() {\n    return f" + std::to_string(fn - 1) + "(10, 1.5);\n}\n";
+    return src;
+}
+
+struct ModeResult {
+    double seconds = 0;
+    size_t tokens = 0;
+    size_t streamBytes = 0;
+};
+
+// Lexes and parses the buffer iterations times, discarding each AST. jobs > 1
+// parses the pre-lexed stream in parallel.
+static ModeResult runMode(unsigned bufferId, bool prelex, unsigned jobs, int iterations) {
+    ModeResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        TokenStream tokens;
+        if (prelex) {
+            tokens = lexAll(bufferId);
+            usePrelexedTokens(&tokens);
+            result.tokens = tokens.size();
+            result.streamBytes = tokens.memoryUsage();
+        } else {
+            usePrelexedTokens(nullptr);
+            initLexer(bufferId);
+        }
+        ASTArena arena;
+        CurrentArena = &arena;
+        ProgramNode *program;
+        if (jobs > 1) {
+            program = parseProgramParallel(tokens, jobs);
+        } else {
+            getNextToken();
+            program = parseProgram();
+        }
+        if (!program) {
+            fprintf(stderr, "parse failed\n");
+            exit(1);
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 5;
+    unsigned jobs = 1;
+    const char *file = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "-n") && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-j") && i + 1 < argc)
+            jobs = atoi(argv[++i]);
+        else
+            file = argv[i];
+    }
+
+    unsigned bufferId;
+    if (file) {
+        std::error_code EC;
+        bufferId = loadSourceFile(file, EC);
+        if (!bufferId) {
+            fprintf(stderr, "%s: %s\n", file, EC.message().c_str());
+            return 1;
+        }
+    } else {
+        auto buffer = llvm::MemoryBuffer::getMemBufferCopy(generateProgram(4 << 20), "<synthetic>");
+        bufferId = SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    }
+    const llvm::MemoryBuffer *buffer = SrcMgr.getMemoryBuffer(bufferId);
+    double megabytes = buffer->getBufferSize() / 1e6;
+    printf("%s: %.2f MB, %d iterations\n", buffer->getBufferIdentifier().str().c_str(), megabytes,
+           iterations);
+
+    struct Mode {
+        const char *name;
+        bool prelex;
+        unsigned jobs;
+    };
+    std::vector<Mode> modes = {{"streaming", false, 1}, {"prelexed", true, 1}};
+    std::string parallelName = "-j " + std::to_string(jobs);
+    if (jobs > 1)
+        modes.push_back({parallelName.c_str(), true, jobs});
+
+    double streamingSeconds = 0;
+    for (const Mode &mode : modes) {
+        int fds[2];
+        if (pipe(fds) != 0) {
+            perror("pipe");
+            return 1;
+        }
+        pid_t pid = fork();
+        if (pid == 0) {
+            close(fds[0]);
+            ModeResult result = runMode(bufferId, mode.prelex, mode.jobs, iterations);
+            if (write(fds[1], &result, sizeof(result)) != sizeof(result))
+                _exit(1);
+            _exit(0);
+        }
+        close(fds[1]);
+
+        ModeResult result;
+        bool received = read(fds[0], &result, sizeof(result)) == sizeof(result);
+        close(fds[0]);
+        int status = 0;
+        struct rusage usage;
+        wait4(pid, &status, 0, &usage);
+        if (!received || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            fprintf(stderr, "%s run failed\n", mode.name);
+            return 1;
+        }
+
+        double perIteration = result.seconds / iterations;
+        if (!mode.prelex)
+            streamingSeconds = result.seconds;
+        printf("  %-10s %8.2f ms/iteration %9.1f MB/s  peak RSS %7.1f MB", mode.name,
+               perIteration * 1e3, megabytes / perIteration, usage.ru_maxrss / 1024.0);
+        if (mode.prelex)
+            printf("  (%zu tokens, stream %.1f MB, %.2fx streaming time)", result.tokens,
+                   result.streamBytes / 1e6, result.seconds / streamingSeconds);
+        printf("\n");
+    }
+    return 0;
+}
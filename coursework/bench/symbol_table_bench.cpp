@@ -0,0 +1,184 @@
+// Scoped symbol table microbenchmark: deeply nested blocks and very wide functions.
+//
+// Usage: ./symbol_table_bench [-n iterations] [-d depth] [-w locals]
+//
+// Replays the declarations and lookups sema makes on two shapes of program
+// against ScopedSymbolTable (scoped_symbol_table.h) and against the stack of
+// DenseMaps, one per scope plus one for the globals, that it replaced:
+//   nested - depth blocks, each inside the last, that declare one local and
+//            then read a global, the outermost local and their own local;
+//   wide   - one function that declares locals one after another, each checked
+//            for a redefinition first, then reads every one of them.
+// Both tables are given the same operations and must find the same values.
+// Then the matching MiniC programs are generated, parsed and timed through
+// sema() itself, so the effect on the whole pass is seen too.
+#include "interner.h"
+#include "lexer.h"
+#include "parser.h"
+#include "scoped_symbol_table.h"
+#include "sema.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include "llvm/ADT/DenseMap.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// The old layout: a linear search of the scopes from the innermost out
+template <typename T>
+class DenseMapScopes {
+    std::vector<llvm::DenseMap<Symbol, T>> scopes;
+    llvm::DenseMap<Symbol, T> globals;
+
+    llvm::DenseMap<Symbol, T>& current() { return scopes.empty() ? globals : scopes.back(); }
+
+public:
+    unsigned depth() const { return scopes.size(); }
+    void pushScope() { scopes.emplace_back(); }
+    void popScope() { scopes.pop_back(); }
+    void declare(Symbol name, const T& value) { current()[name] = value; }
+
+    const T* lookup(Symbol name) const {
+        for (auto scope = scopes.rbegin(); scope != scopes.rend(); ++scope) {
+            auto it = scope->find(name);
+            if (it != scope->end())
+                return &it->second;
+        }
+        auto it = globals.find(name);
+        return it != globals.end() ? &it->second : nullptr;
+    }
+
+    const T* lookupInCurrentScope(Symbol name) const {
+        const auto& scope = scopes.empty() ? globals : scopes.back();
+        auto it = scope.find(name);
+        return it != scope.end() ? &it->second : nullptr;
+    }
+};
+
+static std::vector<Symbol> internNames(const char* prefix, int count) {
+    std::vector<Symbol> names;
+    for (int i = 0; i < count; ++i)
+        names.push_back(intern(prefix + std::to_string(i)));
+    return names;
+}
+
+// Each run leaves the table as it found it, holding only the global, so like
+// sema's table across functions it is reused and keeps its capacity. Returns a
+// checksum of the values found, which must agree between the two tables.
+template <typename Table>
+static uint64_t runNested(Table& table, const std::vector<Symbol>& locals, Symbol global) {
+    uint64_t sum = 0;
+    for (size_t d = 0; d < locals.size(); ++d) {
+        table.pushScope();
+        table.declare(locals[d], uint32_t(d + 2));
+        sum += *table.lookup(global) + *table.lookup(locals[0]) + *table.lookup(locals[d]);
+    }
+    for (size_t d = 0; d < locals.size(); ++d)
+        table.popScope();
+    return sum;
+}
+
+template <typename Table>
+static uint64_t runWide(Table& table, const std::vector<Symbol>& locals) {
+    table.pushScope();
+    for (size_t i = 0; i < locals.size(); ++i) {
+        if (table.lookupInCurrentScope(locals[i]))
+            return 0;
+        table.declare(locals[i], uint32_t(i));
+    }
+    uint64_t sum = 0;
+    for (Symbol name : locals)
+        sum += *table.lookup(name);
+    table.popScope();
+    return sum;
+}
+
+template <typename Fn>
+static double timeIterations(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+        fn();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / iterations;
+}
+
+static std::string generateNested(int depth) {
+    std::string src = "int g;\nint main() {\n";
+    for (int d = 0; d < depth; ++d)
+        src += "{ int v" + std::to_string(d) + "; v" + std::to_string(d) + " = g + v0;\n";
+    src += std::string(depth, '}') + "\nreturn g;\n}\n";
+    return src;
+}
+
+static std::string generateWide(int locals) {
+    std::string src = "int main() {\n";
+    for (int i = 0; i < locals; ++i)
+        src += "    int v" + std::to_string(i) + ";\n";
+    for (int i = 0; i < locals; ++i)
+        src += "    v" + std::to_string(i) + " = v" + std::to_string((i * 7) % locals) + " + 1;\n";
+    src += "    return v0;\n}\n";
+    return src;
+}
+
+static double timeSema(const std::string& src, const char* name, int iterations) {
+    auto buffer = llvm::MemoryBuffer::getMemBufferCopy(src, name);
+    unsigned bufferId = SrcMgr.AddNewSourceBuffer(std::move(buffer), llvm::SMLoc());
+    TokenStream tokens = lexAll(bufferId);
+    usePrelexedTokens(&tokens);
+    ASTArena arena;
+    CurrentArena = &arena;
+    getNextToken();
+    ASTnode* tree = parseProgram();
+    if (!tree) {
+        fprintf(stderr, "%s: parse failed\n", name);
+        exit(1);
+    }
+    return timeIterations(iterations, [&] { sema(tree); });
+}
+
+int main(int argc, char** argv) {
+    int iterations = 20;
+    int depth = 2000;
+    int width = 10000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "-n"))
+            iterations = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-d"))
+            depth = atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "-w"))
+            width = atoi(argv[i + 1]);
+    }
+
+    Symbol global = intern("g");
+    std::vector<Symbol> nestedLocals = internNames("v", depth);
+    std::vector<Symbol> wideLocals = internNames("w", width);
+    ScopedSymbolTable<uint32_t> scoped;
+    DenseMapScopes<uint32_t> maps;
+    scoped.declare(global, 1);
+    maps.declare(global, 1);
+    if (runNested(scoped, nestedLocals, global) != runNested(maps, nestedLocals, global) ||
+        runWide(scoped, wideLocals) != runWide(maps, wideLocals)) {
+        fprintf(stderr, "the two tables found different values\n");
+        return 1;
+    }
+
+    uint64_t sink = 0;
+    double nestedScoped = timeIterations(iterations, [&] { sink += runNested(scoped, nestedLocals, global); });
+    double nestedMaps = timeIterations(iterations, [&] { sink += runNested(maps, nestedLocals, global); });
+    double wideScoped = timeIterations(iterations, [&] { sink += runWide(scoped, wideLocals); });
+    double wideMaps = timeIterations(iterations, [&] { sink += runWide(maps, wideLocals); });
+    double nestedSema = timeSema(generateNested(depth), "<nested>", iterations);
+    double wideSema = timeSema(generateWide(width), "<wide>", iterations);
+
+    printf("%-8s %8s %14s %14s %9s %10s\n", "shape", "size", "scoped table", "DenseMap stack", "speedup",
+           "sema ms");
+    printf("%-8s %8d %11.3f ms %11.3f ms %8.1fx %10.3f\n", "nested", depth, nestedScoped * 1e3, nestedMaps * 1e3,
+           nestedMaps / nestedScoped, nestedSema * 1e3);
+    printf("%-8s %8d %11.3f ms %11.3f ms %8.1fx %10.3f\n", "wide", width, wideScoped * 1e3, wideMaps * 1e3,
+           wideMaps / wideScoped, wideSema * 1e3);
+    if (sink == 0)
+        printf("  (no lookups made)\n");
+    return 0;
+}
@@ -0,0 +1,7 @@
+// A function whose body is empty
+void f() {}
+
+int main() {
+    f();
+    return 0;
+}
@@ -0,0 +1,8 @@
+// Empty while and else blocks
+int main() {
+    int i;
+    i = 0;
+    while (i > 10) {}
+    if (i == 0) { i = 1; } else {}
+    return i;
+}
@@ -0,0 +1,7 @@
+// An if whose then block is empty
+int main() {
+    int x;
+    x = 1;
+    if (x) {}
+    return 0;
+}
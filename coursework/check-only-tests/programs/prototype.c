@@ -0,0 +1,4 @@
+// A prototype that is never defined, as in syntax/terminals/various_2_f.c
+extern int foo();
+
+int foo2();
@@ -0,0 +1,10 @@
+// A call through a prototype to a function defined later
+int next(int n);
+
+int main() {
+    return next(1);
+}
+
+int next(int n) {
+    return n + 1;
+}
@@ -0,0 +1,4 @@
+// A prototype may repeat a definition, but a second definition is an error
+int one() { return 1; }
+int one();
+int one() { return 2; }
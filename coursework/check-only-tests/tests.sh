@@ -0,0 +1,86 @@
+#!/bin/bash
+set -e
+export LLVM_INSTALL_PATH=/modules/cs325/llvm-18.1.8
+export PATH=$LLVM_INSTALL_PATH/bin:$PATH
+export LD_LIBRARY_PATH=$LLVM_INSTALL_PATH/lib:$LD_LIBRARY_PATH
+
+module load GCC/13.3.0
+
+DIR="$(pwd)"
+
+### Build mccomp compiler
+echo "Cleanup *****"
+rm -rf ./mccomp
+
+echo "Compile *****"
+
+make clean
+make -j mccomp
+
+COMP=$DIR/mccomp
+echo $COMP
+
+GEN_DIR=$DIR/check-only-tests/gen
+
+# Compiles $1 with the remaining arguments; diagnostics go to $GEN_DIR/$2.err
+# and the exit status to $GEN_DIR/$2.rc
+function compile {
+  local src=$1 out=$2
+  shift 2
+  local rc=0
+  "$COMP" "$@" "$src" -o $GEN_DIR/$out.ll > /dev/null 2> $GEN_DIR/$out.err || rc=$?
+  echo $rc > $GEN_DIR/$out.rc
+}
+
+# Every program, valid or not, is compiled with --check-only and in full. Both
+# must accept it or both reject it with the same diagnostics.
+function run_agreement_test {
+  mkdir -p $GEN_DIR
+  echo
+  echo "agreement: --check-only against a full compile"
+  local failed=0 count=0
+  for src in check-only-tests/programs/*.c tests/*/*.c cult-tests/*/*.c minic-medium-tests/*/*.c \
+             minic-medium-tests/fail/*.c Alex-Tests/*/*/*.c syntax/terminals/*.c; do
+    [ -f $src ] || continue
+    rm -f $GEN_DIR/*
+    compile $src checked --check-only
+    compile $src full
+    count=$((count + 1))
+    if ! cmp -s $GEN_DIR/checked.rc $GEN_DIR/full.rc; then
+      echo "  $src: --check-only exited $(cat $GEN_DIR/checked.rc), a full compile $(cat $GEN_DIR/full.rc)"
+      failed=1
+    elif ! cmp -s $GEN_DIR/checked.err $GEN_DIR/full.err; then
+      echo "  $src: the diagnostics differ"
+      failed=1
+    fi
+  done
+  if (( failed )); then
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "  $count programs"
+  echo "PASSED"
+  rm -rf $GEN_DIR
+}
+
+function list_options {
+  echo "Select a test to run:"
+  echo "1) agreement (every test program, --check-only and full)"
+  echo "2) Run all tests"
+  echo "q) Quit"
+}
+
+function run_all_tests {
+  run_agreement_test
+}
+
+while true; do
+  list_options
+  read -p "Enter your choice: " choice
+  case $choice in
+    1) run_agreement_test ;;
+    2) run_all_tests ;;
+    q) echo "Exiting."; exit 0 ;;
+    *) echo "Invalid choice. Please try again." ;;
+  esac
+done
@@ -1,295 +1,351 @@
 #ifndef AST_H
 #define AST_H
 
+#include <cstdint>
 #include <string>
-#include <memory>
-#include <vector>
+#include <utility>
 #include "tokens.h"
+#include "ast_arena.h"
+#include "operators.h"
+#include "minic_type.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/IR/Value.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/raw_ostream.h"
 
 using namespace llvm;
 
+// A parameter's type and name
+using Param = std::pair<MiniCType, Symbol>;
+
 /**
 * @brief Base class for all Abstract Syntax Tree nodes
-* 
+*
 * @details
-* Derived classes implement codegen() for LLVM IR generation and to_string() 
-* for AST visualisation like the coursework pdf suggested.
+* Every node records its Kind, so isa<>, cast<> and dyn_cast<> work on the AST
+* without C++ RTTI (the project builds with -fno-rtti), and passes are written
+* as visitors (ast_visitor.h) that dispatch on the Kind instead of adding a
+* virtual method to every class. Code generation is the CodeGen visitor
+* (codegen.h) and the AST dump is dumpAST() below.
 * Also added the token info so that each node stores its source location (line, column) for error reporting.
-*/class ASTnode {
+* Nodes are allocated in an ASTArena (ast_arena.h) and never destroyed one by one,
+* so children are plain pointers and arena arrays, names are Symbols and types
+* are MiniCTypes. The semantic analysis pass (sema.h) fills in each expression's
+* type and what its names resolve to, which codegen then reads back.
+*/
+class ASTnode {
+public:
+    enum class Kind : uint8_t {
+#define AST_NODE(Name) Name,
+#include "ast_nodes.def"
+    };
+
+private:
+    const Kind kind;
+    MiniCType exprType = MiniCType::Void;
+
 protected:
-    static std::string getPrefix(int indent, bool isLast);
-    static std::string getChildIndent(int indent, bool isLast);
+    ASTnode(Kind kind, const TOKEN& location) : kind(kind), loc(location) {}
 
 public:
     TOKEN loc;
-    virtual ~ASTnode() {}
-    virtual Value* codegen() = 0;
-    virtual std::string to_string(int indent = 0, bool isLast = true) const {
-        return std::string(indent, ' ') + "ASTnode\n";
-    }
+
+    Kind getKind() const { return kind; }
+    const TOKEN& getLoc() const { return loc; }
+    // Type of an expression's value, set by sema; Void for everything else
+    MiniCType getExprType() const { return exprType; }
+    void setExprType(MiniCType type) { exprType = type; }
 };
 
+// Number of ASTnode::Kind values
+inline constexpr size_t NumASTKinds = 0
+#define AST_NODE(Name) +1
+#include "ast_nodes.def"
+    ;
+
+// Output of mccomp --ast-dump
+enum class ASTDumpFormat { None, Tree, JSON };
+
+/**
+ * @brief Writes the AST rooted at node to os.
+ *
+ * @details Tree is the indented, colour-annotated outline mccomp has always
+ * printed; JSON is one object per node for other tools. Either is written while
+ * the tree is walked, without building the dump in memory first, and dumps may
+ * run concurrently as the dumpers keep their state to themselves. The walk uses
+ * an explicit stack, so any depth of nesting the parser accepts can be dumped;
+ * past 64 levels the tree elides its outer connectors and JSON is written
+ * without indentation, keeping the dump linear in the size of the AST.
+ */
+void dumpAST(const ASTnode* node, llvm::raw_ostream& os, ASTDumpFormat format = ASTDumpFormat::Tree);
+
+// The tree dump of node as a string
+std::string to_string(const ASTnode* node);
+
 class TypeNode : public ASTnode {
-    std::string typeName;
+    MiniCType type;
 public:
-    TypeNode(std::string typeName, const TOKEN& location = TOKEN())
-        : typeName(typeName) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+    TypeNode(MiniCType type, const TOKEN& location = TOKEN())
+        : ASTnode(Kind::Type, location), type(type) {}
+    MiniCType getType() const { return type; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Type; }
 };
 
 class ProgramNode : public ASTnode {
-    std::vector<std::unique_ptr<ASTnode>> externs;
-    std::vector<std::unique_ptr<ASTnode>> declarations;
+    llvm::ArrayRef<ASTnode*> externs;
+    llvm::ArrayRef<ASTnode*> declarations;
 public:
-    ProgramNode(std::vector<std::unique_ptr<ASTnode>> exts, 
-                std::vector<std::unique_ptr<ASTnode>> decls,
+    ProgramNode(llvm::ArrayRef<ASTnode*> exts,
+                llvm::ArrayRef<ASTnode*> decls,
                 const TOKEN& location = TOKEN())
-        : externs(std::move(exts)), declarations(std::move(decls)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Program, location), externs(exts), declarations(decls) {}
+    llvm::ArrayRef<ASTnode*> getExterns() const { return externs; }
+    llvm::ArrayRef<ASTnode*> getDeclarations() const { return declarations; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Program; }
 };
 
 class ExternNode : public ASTnode {
-    std::string type;
-    std::string name;
-    std::vector<std::pair<std::string, std::string>> params;
+    MiniCType type;
+    Symbol name;
+    llvm::ArrayRef<Param> params;
+    uint32_t functionIndex = 0;
 public:
-    ExternNode(std::string type, std::string name, 
-               std::vector<std::pair<std::string, std::string>> params,
+    ExternNode(MiniCType type, Symbol name,
+               llvm::ArrayRef<Param> params,
                const TOKEN& location = TOKEN())
-        : type(type), name(name), params(params) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Extern, location), type(type), name(name), params(params) {}
+    MiniCType getType() const { return type; }
+    Symbol getName() const { return name; }
+    llvm::ArrayRef<Param> getParams() const { return params; }
+    uint32_t getFunctionIndex() const { return functionIndex; }
+    void setFunctionIndex(uint32_t index) { functionIndex = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Extern; }
 };
 
 class VarDeclNode : public ASTnode {
-    std::string type;
-    std::string name;
+    MiniCType type;
+    Symbol name;
+    uint32_t slot = 0;
 public:
-    VarDeclNode(std::string type, std::string name,
+    VarDeclNode(MiniCType type, Symbol name,
                 const TOKEN& location = TOKEN())
-        : type(type), name(name) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::VarDecl, location), type(type), name(name) {}
+    MiniCType getType() const { return type; }
+    Symbol getName() const { return name; }
+    uint32_t getSlot() const { return slot; }
+    void setSlot(uint32_t index) { slot = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::VarDecl; }
 };
 
 class FunctionNode : public ASTnode {
-    std::string returnType;
-    std::string name;
-    std::vector<std::pair<std::string, std::string>> params;
-    std::unique_ptr<ASTnode> body;
+    MiniCType returnType;
+    Symbol name;
+    llvm::ArrayRef<Param> params;
+    ASTnode* body;
+    uint32_t functionIndex = 0;
 public:
-    FunctionNode(std::string returnType, std::string name,
-                 std::vector<std::pair<std::string, std::string>> params,
-                 std::unique_ptr<ASTnode> body,
+    FunctionNode(MiniCType returnType, Symbol name,
+                 llvm::ArrayRef<Param> params,
+                 ASTnode* body,
                  const TOKEN& location = TOKEN())
-        : returnType(returnType), name(name), params(params), body(std::move(body)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Function, location), returnType(returnType), name(name), params(params),
+          body(body) {}
+    MiniCType getReturnType() const { return returnType; }
+    Symbol getName() const { return name; }
+    llvm::ArrayRef<Param> getParams() const { return params; }
+    ASTnode* getBody() const { return body; } // nullptr for a prototype
+    uint32_t getFunctionIndex() const { return functionIndex; }
+    void setFunctionIndex(uint32_t index) { functionIndex = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Function; }
 };
 
 
 class BlockNode : public ASTnode {
-    std::vector<std::unique_ptr<ASTnode>> declarations;
-    std::vector<std::unique_ptr<ASTnode>> statements;
+    llvm::ArrayRef<ASTnode*> declarations;
+    llvm::ArrayRef<ASTnode*> statements;
 public:
-    BlockNode(std::vector<std::unique_ptr<ASTnode>> decls,
-              std::vector<std::unique_ptr<ASTnode>> stmts,
+    BlockNode(llvm::ArrayRef<ASTnode*> decls,
+              llvm::ArrayRef<ASTnode*> stmts,
               const TOKEN& location = TOKEN())
-        : declarations(std::move(decls)), statements(std::move(stmts)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Block, location), declarations(decls), statements(stmts) {}
+    llvm::ArrayRef<ASTnode*> getDeclarations() const { return declarations; }
+    llvm::ArrayRef<ASTnode*> getStatements() const { return statements; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Block; }
 };
 
 
 class IfNode : public ASTnode {
-    std::unique_ptr<ASTnode> condition;
-    std::unique_ptr<ASTnode> thenBlock;
-    std::unique_ptr<ASTnode> elseBlock;
+    ASTnode* condition;
+    ASTnode* thenBlock;
+    ASTnode* elseBlock;
 public:
-    IfNode(std::unique_ptr<ASTnode> cond,
-           std::unique_ptr<ASTnode> thenB,
-           std::unique_ptr<ASTnode> elseB = nullptr,
+    IfNode(ASTnode* cond,
+           ASTnode* thenB,
+           ASTnode* elseB = nullptr,
            const TOKEN& location = TOKEN())
-        : condition(std::move(cond)), thenBlock(std::move(thenB)), 
-          elseBlock(std::move(elseB)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::If, location), condition(cond), thenBlock(thenB),
+          elseBlock(elseB) {}
+    ASTnode* getCondition() const { return condition; }
+    ASTnode* getThen() const { return thenBlock; }
+    ASTnode* getElse() const { return elseBlock; } // nullptr without an else
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::If; }
 };
 class WhileNode : public ASTnode {
-    std::unique_ptr<ASTnode> condition;
-    std::unique_ptr<ASTnode> body;
+    ASTnode* condition;
+    ASTnode* body;
 public:
-    WhileNode(std::unique_ptr<ASTnode> cond, 
-              std::unique_ptr<ASTnode> body,
+    WhileNode(ASTnode* cond,
+              ASTnode* body,
               const TOKEN& location = TOKEN())
-        : condition(std::move(cond)), body(std::move(body)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::While, location), condition(cond), body(body) {}
+    ASTnode* getCondition() const { return condition; }
+    ASTnode* getBody() const { return body; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::While; }
 };
 
 class ExternListNode : public ASTnode {
+    llvm::ArrayRef<ASTnode*> externs;
 public:
-    std::vector<std::unique_ptr<ASTnode>> externs;
-    
-    ExternListNode(std::vector<std::unique_ptr<ASTnode>> exts,
+    ExternListNode(llvm::ArrayRef<ASTnode*> exts,
                    const TOKEN& location = TOKEN())
-        : externs(std::move(exts)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::ExternList, location), externs(exts) {}
+    llvm::ArrayRef<ASTnode*> getExterns() const { return externs; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::ExternList; }
 };
 
 class DeclListNode : public ASTnode {
+    llvm::ArrayRef<ASTnode*> declarations;
 public:
-    std::vector<std::unique_ptr<ASTnode>> declarations;
-    
-    DeclListNode(std::vector<std::unique_ptr<ASTnode>> decls,
+    DeclListNode(llvm::ArrayRef<ASTnode*> decls,
                  const TOKEN& location = TOKEN())
-        : declarations(std::move(decls)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::DeclList, location), declarations(decls) {}
+    llvm::ArrayRef<ASTnode*> getDeclarations() const { return declarations; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::DeclList; }
 };
 
 class ReturnNode : public ASTnode {
-    std::unique_ptr<ASTnode> value;
+    ASTnode* value;
 public:
-    ReturnNode(std::unique_ptr<ASTnode> val = nullptr,
+    ReturnNode(ASTnode* val = nullptr,
                const TOKEN& location = TOKEN())
-        : value(std::move(val)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Return, location), value(val) {}
+    ASTnode* getValue() const { return value; } // nullptr for a bare return
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Return; }
 };
 
 class ExprStmtNode : public ASTnode {
-    std::unique_ptr<ASTnode> expr;
+    ASTnode* expr;
 public:
-    ExprStmtNode(std::unique_ptr<ASTnode> expr,
+    ExprStmtNode(ASTnode* expr,
                  const TOKEN& location = TOKEN())
-        : expr(std::move(expr)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::ExprStmt, location), expr(expr) {}
+    ASTnode* getExpr() const { return expr; } // nullptr for an empty statement
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::ExprStmt; }
 };
 
 class BinaryOpNode : public ASTnode {
-    std::string op;
-    std::unique_ptr<ASTnode> left;
-    std::unique_ptr<ASTnode> right;
+    BinaryOp op;
+    ASTnode* left;
+    ASTnode* right;
 public:
-    BinaryOpNode(std::string op,
-                 std::unique_ptr<ASTnode> left,
-                 std::unique_ptr<ASTnode> right,
+    BinaryOpNode(BinaryOp op,
+                 ASTnode* left,
+                 ASTnode* right,
                  const TOKEN& location = TOKEN())
-        : op(op), left(std::move(left)), right(std::move(right)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::BinaryOp, location), op(op), left(left), right(right) {}
+    BinaryOp getOp() const { return op; }
+    ASTnode* getLeft() const { return left; }
+    ASTnode* getRight() const { return right; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::BinaryOp; }
 };
 
 class UnaryOpNode : public ASTnode {
-    std::string op;
-    std::unique_ptr<ASTnode> operand;
+    UnaryOp op;
+    ASTnode* operand;
 public:
-    UnaryOpNode(std::string op, 
-                std::unique_ptr<ASTnode> operand,
+    UnaryOpNode(UnaryOp op,
+                ASTnode* operand,
                 const TOKEN& location = TOKEN())
-        : op(op), operand(std::move(operand)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::UnaryOp, location), op(op), operand(operand) {}
+    UnaryOp getOp() const { return op; }
+    ASTnode* getOperand() const { return operand; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::UnaryOp; }
 };
 
 class AssignNode : public ASTnode {
-    std::string name;
-    std::unique_ptr<ASTnode> value;
+    Symbol name;
+    ASTnode* value;
+    uint32_t slot = 0;
 public:
-    AssignNode(std::string name, 
-               std::unique_ptr<ASTnode> value,
+    AssignNode(Symbol name,
+               ASTnode* value,
                const TOKEN& location = TOKEN())
-        : name(name), value(std::move(value)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Assign, location), name(name), value(value) {}
+    Symbol getName() const { return name; }
+    ASTnode* getValue() const { return value; }
+    uint32_t getSlot() const { return slot; }
+    void setSlot(uint32_t index) { slot = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Assign; }
 };
 
 class VariableNode : public ASTnode {
-    std::string name;
+    Symbol name;
+    uint32_t slot = 0;
 public:
-    VariableNode(std::string name,
+    VariableNode(Symbol name,
                  const TOKEN& location = TOKEN())
-        : name(name) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::Variable, location), name(name) {}
+    Symbol getName() const { return name; }
+    uint32_t getSlot() const { return slot; }
+    void setSlot(uint32_t index) { slot = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Variable; }
 };
 class FunctionCallNode : public ASTnode {
-    std::string name;
-    std::vector<std::unique_ptr<ASTnode>> arguments;
+    Symbol name;
+    llvm::ArrayRef<ASTnode*> arguments;
+    uint32_t callee = 0;
 public:
-    FunctionCallNode(std::string name, 
-                    std::vector<std::unique_ptr<ASTnode>> args,
+    FunctionCallNode(Symbol name,
+                    llvm::ArrayRef<ASTnode*> args,
                     const TOKEN& location = TOKEN())
-        : name(name), arguments(std::move(args)) {
-        loc = location;
-    }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+        : ASTnode(Kind::FunctionCall, location), name(name), arguments(args) {}
+    Symbol getName() const { return name; }
+    llvm::ArrayRef<ASTnode*> getArguments() const { return arguments; }
+    uint32_t getCallee() const { return callee; } // function index of the callee
+    void setCallee(uint32_t index) { callee = index; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::FunctionCall; }
 };
 
 class LiteralNode : public ASTnode {
-    enum class LiteralType { Int, Float, Bool } type;
+public:
+    enum class LiteralType { Int, Float, Bool };
+
+private:
+    LiteralType type;
     union {
         int intValue;
         float floatValue;
         bool boolValue;
     } value;
+
 public:
-    LiteralNode(int val, const TOKEN& location = TOKEN()) 
-        : type(LiteralType::Int) { 
-        value.intValue = val; 
-        loc = location;
+    LiteralNode(int val, const TOKEN& location = TOKEN())
+        : ASTnode(Kind::Literal, location), type(LiteralType::Int) {
+        value.intValue = val;
     }
-    LiteralNode(float val, const TOKEN& location = TOKEN()) 
-        : type(LiteralType::Float) { 
-        value.floatValue = val; 
-        loc = location;
+    LiteralNode(float val, const TOKEN& location = TOKEN())
+        : ASTnode(Kind::Literal, location), type(LiteralType::Float) {
+        value.floatValue = val;
     }
-    LiteralNode(bool val, const TOKEN& location = TOKEN()) 
-        : type(LiteralType::Bool) { 
-        value.boolValue = val; 
-        loc = location;
+    LiteralNode(bool val, const TOKEN& location = TOKEN())
+        : ASTnode(Kind::Literal, location), type(LiteralType::Bool) {
+        value.boolValue = val;
     }
-    Value* codegen() override;
-    std::string to_string(int indent = 0, bool isLast = true) const override;
+    LiteralType getLiteralType() const { return type; }
+    int getInt() const { return value.intValue; }
+    float getFloat() const { return value.floatValue; }
+    bool getBool() const { return value.boolValue; }
+    static bool classof(const ASTnode* node) { return node->getKind() == Kind::Literal; }
 };
 
-#endif
\ No newline at end of file
+#endif
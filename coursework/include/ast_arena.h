@@ -0,0 +1,100 @@
+#ifndef AST_ARENA_H
+#define AST_ARENA_H
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/Support/Allocator.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Bump-pointer arena holding one compilation's AST.
+ *
+ * @details Every AST node and every child array is carved out of large slabs, so
+ * building a node is a pointer bump instead of a heap allocation, and the whole
+ * tree is released in one go when the arena is destroyed. Node destructors never
+ * run; nodes therefore only hold trivially destructible members: child pointers,
+ * arena arrays, Symbols and views into the source buffers.
+ *
+ * An arena is not thread safe. A thread that parses in parallel with others takes
+ * its own child arena from createChild(); children are owned by, and freed with,
+ * their parent.
+ */
+class ASTArena {
+    llvm::BumpPtrAllocator Allocator;
+    std::vector<std::unique_ptr<ASTArena>> Children;
+    std::mutex ChildrenMutex;
+    size_t NumNodes = 0;
+    size_t NumArrays = 0;
+
+public:
+    template <typename T, typename... Args>
+    T* create(Args&&... args) {
+        ++NumNodes;
+        return new (Allocator.Allocate<T>()) T(std::forward<Args>(args)...);
+    }
+
+    // Copies items into the arena; the copy lives as long as the arena
+    template <typename T>
+    llvm::ArrayRef<T> copy(llvm::ArrayRef<T> items) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena arrays are never destroyed");
+        if (items.empty())
+            return {};
+        ++NumArrays;
+        T* storage = Allocator.Allocate<T>(items.size());
+        std::uninitialized_copy(items.begin(), items.end(), storage);
+        return {storage, items.size()};
+    }
+
+    // A new arena for another thread, freed together with this one
+    ASTArena& createChild() {
+        std::lock_guard<std::mutex> lock(ChildrenMutex);
+        Children.push_back(std::make_unique<ASTArena>());
+        return *Children.back();
+    }
+
+    // Totals for this arena and its children
+    size_t nodeCount() const;
+    size_t arrayCount() const;
+    size_t bytesAllocated() const;
+};
+
+inline size_t ASTArena::nodeCount() const {
+    size_t count = NumNodes;
+    for (const auto& child : Children)
+        count += child->nodeCount();
+    return count;
+}
+
+inline size_t ASTArena::arrayCount() const {
+    size_t count = NumArrays;
+    for (const auto& child : Children)
+        count += child->arrayCount();
+    return count;
+}
+
+inline size_t ASTArena::bytesAllocated() const {
+    size_t bytes = Allocator.getBytesAllocated();
+    for (const auto& child : Children)
+        bytes += child->bytesAllocated();
+    return bytes;
+}
+
+// Arena the parsers on this thread build nodes in. Must be set before parsing.
+extern thread_local ASTArena* CurrentArena;
+
+template <typename T, typename... Args>
+T* newNode(Args&&... args) {
+    return CurrentArena->create<T>(std::forward<Args>(args)...);
+}
+
+template <typename T>
+llvm::ArrayRef<T> arenaArray(llvm::ArrayRef<T> items) {
+    return CurrentArena->copy(items);
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef AST_FILE_H
+#define AST_FILE_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <system_error>
+#include "flat_ast.h"
+
+/**
+ * @brief Binary AST files: a FlatAST saved so later compiles of the same
+ * source can skip lexing and parsing.
+ *
+ * @details A file is an ASTFileHeader followed by the FlatAST's node, signature
+ * and parameter arrays exactly as they are laid out in memory, then the
+ * spelling of every symbol they use as NUL-terminated strings. Symbols are
+ * renumbered 1..numSymbols in order of first use, so a compile that interns
+ * nothing before loading (mccomp --load-ast) gets the same numbers back and the
+ * arrays are used in place, straight from the mapped file. Otherwise they are
+ * copied and renumbered.
+ *
+ * The header records the size and xxHash64 of the source text the AST was
+ * parsed from, and a file is only accepted for exactly that text. The arrays
+ * are in host byte order and layout: the file is a cache, not an exchange
+ * format. ASTFileVersion must be bumped whenever FlatNode, the node kinds or
+ * any enum stored in a node changes.
+ */
+inline constexpr uint32_t ASTFileVersion = 1;
+
+struct ASTFileHeader {
+    char magic[8];         // "MINICAST"
+    uint32_t version;      // ASTFileVersion
+    uint32_t sourceFileId; // SourceLoc::fileId the locations were recorded with
+    uint64_t sourceSize;
+    uint64_t sourceHash;   // xxHash64 of the source text
+    uint32_t numNodes;
+    uint32_t numSignatures;
+    uint32_t numParams;
+    uint32_t numSymbols;
+};
+
+// Writes ast, parsed from buffer sourceId, to path. Returns false and sets EC on failure.
+bool writeASTFile(const std::string& path, const FlatAST& ast, unsigned sourceId, std::error_code& EC);
+
+// The AST stored in path if it is a well-formed file of this version written for
+// the current text of buffer sourceId; std::nullopt with the reason in whyNot otherwise
+std::optional<FlatAST> readASTFile(const std::string& path, unsigned sourceId, std::string& whyNot);
+
+#endif
@@ -0,0 +1,251 @@
+#ifndef AST_VISITOR_H
+#define AST_VISITOR_H
+
+#include "ast.h"
+#include "llvm/ADT/ArrayRef.h"
+#include <vector>
+
+/**
+ * @brief Statically dispatched visitors over the AST.
+ *
+ * @details A pass derives from one of these templates, passing itself as
+ * Derived (CRTP), and defines visitXNode for the node classes it handles; the
+ * call is resolved at compile time, so there is no virtual call per node and
+ * adding a pass does not touch the node classes.
+ *
+ * ASTVisitor / ConstASTVisitor: visit(node, params...) switches on the node's
+ * Kind and calls Derived::visitXNode(node, params...). A class the pass does not
+ * handle falls back to visitASTnode(), which returns RetTy(). The pass decides
+ * which children to visit and in what order; the code generator and the AST dump
+ * are written this way.
+ *
+ * RecursiveASTVisitor: traverse(node) walks the whole tree in pre-order, calling
+ * Derived::visitXNode(node) on each node before its children. Returning false
+ * from a visit method stops the walk. Passes that only look at some node classes
+ * (statistics, resolution checks) override just those visit methods; a pass can
+ * also override traverseXNode to change how a class's children are walked.
+ *
+ * ExpressionWalker: walkExpression(node) evaluates an expression bottom-up with
+ * explicit stacks, so its depth is bounded by memory rather than the C stack.
+ * A pass derives from it next to ASTVisitorBase and sends the operator,
+ * assignment and call classes to it; the operands of those are walked in the
+ * same loop and every other node is a leaf, evaluated by Derived::visit().
+ */
+template <typename T> using ASTPtr = T*;
+template <typename T> using ConstASTPtr = const T*;
+
+template <template <typename> class Ptr, typename Derived, typename RetTy, typename... ParamTys>
+class ASTVisitorBase {
+    Derived& derived() { return *static_cast<Derived*>(this); }
+
+public:
+    RetTy visit(Ptr<ASTnode> node, ParamTys... params) {
+        switch (node->getKind()) {
+#define AST_NODE(Name)                                                                             \
+    case ASTnode::Kind::Name:                                                                      \
+        return derived().visit##Name##Node(static_cast<Ptr<Name##Node>>(node), params...);
+#include "ast_nodes.def"
+        }
+        return RetTy();
+    }
+
+    RetTy visitASTnode(Ptr<ASTnode>, ParamTys...) { return RetTy(); }
+
+#define AST_NODE(Name)                                                                             \
+    RetTy visit##Name##Node(Ptr<Name##Node> node, ParamTys... params) {                              \
+        return derived().visitASTnode(node, params...);                                            \
+    }
+#include "ast_nodes.def"
+};
+
+template <typename Derived, typename RetTy = void, typename... ParamTys>
+class ASTVisitor : public ASTVisitorBase<ASTPtr, Derived, RetTy, ParamTys...> {};
+
+template <typename Derived, typename RetTy = void, typename... ParamTys>
+class ConstASTVisitor : public ASTVisitorBase<ConstASTPtr, Derived, RetTy, ParamTys...> {};
+
+template <typename Derived>
+class RecursiveASTVisitor {
+    Derived& derived() { return *static_cast<Derived*>(this); }
+
+    bool traverseAll(llvm::ArrayRef<ASTnode*> nodes) {
+        for (ASTnode* node : nodes)
+            if (!derived().traverse(node))
+                return false;
+        return true;
+    }
+
+public:
+    // Visits node and everything below it; nullptr (a missing child) is skipped
+    bool traverse(ASTnode* node) {
+        if (!node)
+            return true;
+        switch (node->getKind()) {
+#define AST_NODE(Name)                                                                             \
+    case ASTnode::Kind::Name:                                                                      \
+        return derived().traverse##Name##Node(static_cast<Name##Node*>(node));
+#include "ast_nodes.def"
+        }
+        return true;
+    }
+
+#define AST_NODE(Name)                                                                             \
+    bool visit##Name##Node(Name##Node*) { return true; }
+#include "ast_nodes.def"
+
+    bool traverseProgramNode(ProgramNode* node) {
+        return derived().visitProgramNode(node) && traverseAll(node->getExterns()) &&
+               traverseAll(node->getDeclarations());
+    }
+    bool traverseExternListNode(ExternListNode* node) {
+        return derived().visitExternListNode(node) && traverseAll(node->getExterns());
+    }
+    bool traverseDeclListNode(DeclListNode* node) {
+        return derived().visitDeclListNode(node) && traverseAll(node->getDeclarations());
+    }
+    bool traverseExternNode(ExternNode* node) { return derived().visitExternNode(node); }
+    bool traverseVarDeclNode(VarDeclNode* node) { return derived().visitVarDeclNode(node); }
+    bool traverseFunctionNode(FunctionNode* node) {
+        return derived().visitFunctionNode(node) && derived().traverse(node->getBody());
+    }
+    bool traverseTypeNode(TypeNode* node) { return derived().visitTypeNode(node); }
+    bool traverseBlockNode(BlockNode* node) {
+        return derived().visitBlockNode(node) && traverseAll(node->getDeclarations()) &&
+               traverseAll(node->getStatements());
+    }
+    bool traverseIfNode(IfNode* node) {
+        return derived().visitIfNode(node) && derived().traverse(node->getCondition()) &&
+               derived().traverse(node->getThen()) && derived().traverse(node->getElse());
+    }
+    bool traverseWhileNode(WhileNode* node) {
+        return derived().visitWhileNode(node) && derived().traverse(node->getCondition()) &&
+               derived().traverse(node->getBody());
+    }
+    bool traverseReturnNode(ReturnNode* node) {
+        return derived().visitReturnNode(node) && derived().traverse(node->getValue());
+    }
+    bool traverseExprStmtNode(ExprStmtNode* node) {
+        return derived().visitExprStmtNode(node) && derived().traverse(node->getExpr());
+    }
+    bool traverseBinaryOpNode(BinaryOpNode* node) {
+        return derived().visitBinaryOpNode(node) && derived().traverse(node->getLeft()) &&
+               derived().traverse(node->getRight());
+    }
+    bool traverseUnaryOpNode(UnaryOpNode* node) {
+        return derived().visitUnaryOpNode(node) && derived().traverse(node->getOperand());
+    }
+    bool traverseAssignNode(AssignNode* node) {
+        return derived().visitAssignNode(node) && derived().traverse(node->getValue());
+    }
+    bool traverseVariableNode(VariableNode* node) { return derived().visitVariableNode(node); }
+    bool traverseFunctionCallNode(FunctionCallNode* node) {
+        return derived().visitFunctionCallNode(node) && traverseAll(node->getArguments());
+    }
+    bool traverseLiteralNode(LiteralNode* node) { return derived().visitLiteralNode(node); }
+};
+
+/**
+ * @brief Post-order evaluation of nested expressions without recursion.
+ *
+ * @details BinaryOpNode, UnaryOpNode, AssignNode and FunctionCallNode have
+ * their operands (left then right, the operand, the value, the arguments)
+ * evaluated in source order, then the node itself. Derived provides:
+ *
+ *   void enterExpression(Ptr<ASTnode> node)
+ *       before any operand of node; optional.
+ *   void exitOperand(Ptr<ASTnode> node, unsigned index, Ptr<ASTnode> operand, RetTy& value)
+ *       as soon as operand number index has its value, which may be replaced,
+ *       and before the next operand is started; optional.
+ *   RetTy exitExpression(Ptr<ASTnode> node, llvm::ArrayRef<RetTy> operands)
+ *       the value of node from those of its operands.
+ *
+ * The stacks are kept between calls, so a pass reuses their capacity.
+ */
+template <template <typename> class Ptr, typename Derived, typename RetTy>
+class ExpressionWalker {
+    struct Frame {
+        Ptr<ASTnode> node;
+        uint32_t firstOperand; // in Operands
+        uint32_t numOperands;
+        uint32_t next;         // operand to evaluate next
+    };
+
+    std::vector<Frame> Frames;
+    std::vector<Ptr<ASTnode>> Operands; // of every frame, outermost first
+    std::vector<RetTy> Values;          // of the operands evaluated so far
+
+    Derived& derived() { return *static_cast<Derived*>(this); }
+
+    void push(Ptr<ASTnode> node) {
+        derived().enterExpression(node);
+        uint32_t first = Operands.size();
+        switch (node->getKind()) {
+            case ASTnode::Kind::BinaryOp: {
+                auto binary = static_cast<Ptr<BinaryOpNode>>(node);
+                Operands.push_back(binary->getLeft());
+                Operands.push_back(binary->getRight());
+                break;
+            }
+            case ASTnode::Kind::UnaryOp:
+                Operands.push_back(static_cast<Ptr<UnaryOpNode>>(node)->getOperand());
+                break;
+            case ASTnode::Kind::Assign:
+                Operands.push_back(static_cast<Ptr<AssignNode>>(node)->getValue());
+                break;
+            case ASTnode::Kind::FunctionCall:
+                for (auto argument : static_cast<Ptr<FunctionCallNode>>(node)->getArguments())
+                    Operands.push_back(argument);
+                break;
+            default:
+                break;
+        }
+        Frames.push_back({node, first, uint32_t(Operands.size() - first), 0});
+    }
+
+    // Hands the value on top of Values to the innermost frame as its next operand
+    void finishOperand() {
+        Frame& frame = Frames.back();
+        derived().exitOperand(frame.node, frame.next, Operands[frame.firstOperand + frame.next], Values.back());
+        ++frame.next;
+    }
+
+    static bool isWalked(ASTnode::Kind kind) {
+        return kind == ASTnode::Kind::BinaryOp || kind == ASTnode::Kind::UnaryOp ||
+               kind == ASTnode::Kind::Assign || kind == ASTnode::Kind::FunctionCall;
+    }
+
+public:
+    void enterExpression(Ptr<ASTnode>) {}
+    void exitOperand(Ptr<ASTnode>, unsigned, Ptr<ASTnode>, RetTy&) {}
+
+    RetTy walkExpression(Ptr<ASTnode> root) {
+        size_t base = Frames.size();
+        push(root);
+        for (;;) {
+            Frame& frame = Frames.back();
+            if (frame.next < frame.numOperands) {
+                Ptr<ASTnode> operand = Operands[frame.firstOperand + frame.next];
+                if (isWalked(operand->getKind())) {
+                    push(operand);
+                } else {
+                    Values.push_back(derived().visit(operand));
+                    finishOperand();
+                }
+                continue;
+            }
+
+            Frame done = frame;
+            Frames.pop_back();
+            RetTy value = derived().exitExpression(
+                done.node, llvm::ArrayRef<RetTy>(Values).take_back(done.numOperands));
+            Values.resize(Values.size() - done.numOperands);
+            Operands.resize(done.firstOperand);
+            if (Frames.size() == base)
+                return value;
+            Values.push_back(value);
+            finishOperand();
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,91 @@
+#ifndef CODEGEN_H
+#define CODEGEN_H
+
+#include "ast.h"
+#include "ast_visitor.h"
+#include "flat_ast.h"
+#include "sema.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Value.h"
+#include <vector>
+
+/**
+ * @brief Lowers the AST to LLVM IR in TheModule (llvm_context.h).
+ *
+ * @details One visit method per node class. Statements return a non-null
+ * placeholder value, expressions their result. The AST must have been through
+ * sema() (sema.h) first: names are reached through the slot and function
+ * numbers it recorded, indexing the tables below, and each implicit conversion
+ * is emitted from the expression type it recorded, so codegen does no lookups
+ * and has no errors to report. TypeNode has no code and falls back to
+ * visitASTnode(). Expressions are generated by ExpressionWalker (ast_visitor.h)
+ * without recursion, so their nesting depth is not limited by the stack.
+ *
+ * Ptr is the visitor's node pointer template: CodeGen walks the tree and
+ * FlatCodeGen a FlatAST (flat_ast.h), from the same source and producing the
+ * same IR.
+ */
+template <template <typename> class Ptr>
+class CodeGenBase : public ASTVisitorBase<Ptr, CodeGenBase<Ptr>, llvm::Value*>,
+                    public ExpressionWalker<Ptr, CodeGenBase<Ptr>, llvm::Value*> {
+    friend class ExpressionWalker<Ptr, CodeGenBase<Ptr>, llvm::Value*>;
+
+    struct DeclaredFunction {
+        llvm::Function* function;
+        llvm::ArrayRef<Param> params;
+    };
+
+    std::vector<llvm::GlobalVariable*> Globals; // by slot without GlobalSlotBit
+    std::vector<llvm::AllocaInst*> Locals;      // of the function being generated
+    std::vector<DeclaredFunction> Functions;    // by function index
+    MiniCType ReturnType = MiniCType::Void;     // of the function being generated
+    // Block each open "&&" or "||" branched from, and the block it merges in
+    std::vector<std::pair<llvm::BasicBlock*, llvm::BasicBlock*>> ShortCircuits;
+
+    llvm::Value* slotAddress(uint32_t slot) const {
+        if (slot & GlobalSlotBit)
+            return Globals[slot & ~GlobalSlotBit];
+        return Locals[slot];
+    }
+
+    // Expressions are generated by ExpressionWalker, which calls these
+    void exitOperand(Ptr<ASTnode> node, unsigned index, Ptr<ASTnode> operand, llvm::Value*& value);
+    llvm::Value* exitExpression(Ptr<ASTnode> node, llvm::ArrayRef<llvm::Value*> operands);
+    llvm::Value* emitBinaryOp(Ptr<BinaryOpNode> node, llvm::Value* L, llvm::Value* R);
+    llvm::Value* emitUnaryOp(Ptr<UnaryOpNode> node, llvm::Value* operand);
+    llvm::Value* emitAssign(Ptr<AssignNode> node, llvm::Value* value);
+
+public:
+    using ASTVisitorBase<Ptr, CodeGenBase<Ptr>, llvm::Value*>::visit;
+
+    llvm::Value* visitProgramNode(Ptr<ProgramNode> node);
+    llvm::Value* visitExternListNode(Ptr<ExternListNode> node);
+    llvm::Value* visitDeclListNode(Ptr<DeclListNode> node);
+    llvm::Value* visitExternNode(Ptr<ExternNode> node);
+    llvm::Value* visitVarDeclNode(Ptr<VarDeclNode> node);
+    llvm::Value* visitFunctionNode(Ptr<FunctionNode> node);
+    llvm::Value* visitBlockNode(Ptr<BlockNode> node);
+    llvm::Value* visitIfNode(Ptr<IfNode> node);
+    llvm::Value* visitWhileNode(Ptr<WhileNode> node);
+    llvm::Value* visitReturnNode(Ptr<ReturnNode> node);
+    llvm::Value* visitExprStmtNode(Ptr<ExprStmtNode> node);
+    llvm::Value* visitBinaryOpNode(Ptr<BinaryOpNode> node);
+    llvm::Value* visitUnaryOpNode(Ptr<UnaryOpNode> node);
+    llvm::Value* visitAssignNode(Ptr<AssignNode> node);
+    llvm::Value* visitVariableNode(Ptr<VariableNode> node);
+    llvm::Value* visitFunctionCallNode(Ptr<FunctionCallNode> node);
+    llvm::Value* visitLiteralNode(Ptr<LiteralNode> node);
+};
+
+using CodeGen = CodeGenBase<ASTPtr>;
+using FlatCodeGen = CodeGenBase<FlatPtr>;
+
+// Generates code for node and everything below it, once sema(node) has run
+llvm::Value* codegen(ASTnode* node);
+
+// Generates code for the whole of a flattened AST, once sema(ast) has run
+llvm::Value* codegen(const FlatAST& ast);
+
+#endif
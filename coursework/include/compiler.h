@@ -0,0 +1,44 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <memory>
+#include <string>
+#include "ast.h"
+#include "optimizer.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+/**
+ * @brief The whole compiler as a library call: MiniC source in, llvm::Module out.
+ *
+ * @details compileModule() runs every stage mccomp runs before it writes its
+ * output: lexing and parsing (or loading a saved AST), semantic analysis, code
+ * generation and the -O pipeline. It hands the module to the caller in memory,
+ * so a tool that links against the compiler can JIT, analyse or transform the
+ * code without writing it as text or bitcode and parsing it back. The module
+ * belongs to TheContext (llvm_context.h) and must be used on that context.
+ *
+ * Errors in the program are reported with reportError(), which exits, as in
+ * mccomp. Other failures, such as an unreadable input, return nullptr with the
+ * reason in error. The AST and the tokens are freed before it returns, and it
+ * may be called again for another file.
+ */
+struct CompileOptions {
+    bool prelex = false;            // lex the whole file before parsing
+    bool ll1 = false;               // use the table-driven parser
+    unsigned jobs = 1;              // parse top-level declarations on this many threads
+    bool flatAST = false;           // generate code from the flattened AST
+    const char* emitASTFile = nullptr;
+    const char* loadASTFile = nullptr;
+    ASTDumpFormat dumpFormat = ASTDumpFormat::None;
+    llvm::raw_ostream* dumpStream = nullptr; // where the AST dump goes; stdout if null
+    bool checkOnly = false;         // stop after semantic analysis, without making a module
+    OptLevel optLevel = OptLevel::O0;
+};
+
+// The module compiled from inputFile ("-" for stdin), or nullptr with the
+// reason in error. error is left empty when the code generator has already
+// reported the failure, and when options.checkOnly stops after a valid program.
+std::unique_ptr<llvm::Module> compileModule(const char* inputFile, const CompileOptions& options, std::string& error);
+
+#endif
@@ -14,6 +14,11 @@ struct CaretPosition {
     bool useDefaultHighlight;
 };
 
+// Runs before a diagnostic is printed from this thread, when set. Parser worker
+// threads use it to hold an error back until every earlier declaration has parsed,
+// so the error reported is the first in source order, as in a serial parse.
+extern thread_local void (*BeforeReportError)();
+
 [[noreturn]] void reportError(const std::string& message, 
                              const TOKEN& token,
                              bool withHighlighting = true,
@@ -0,0 +1,406 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "ast.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+/**
+ * @brief One node of a FlatAST.
+ *
+ * @details 20 bytes against 48-80 for a tree node, most of which is the TOKEN
+ * every tree node carries. Only what diagnostics need of the token is kept: its
+ * SourceLoc and its length (capped at 65535), from which the lexeme is viewed
+ * back out of the source buffer.
+ */
+struct FlatNode {
+    ASTnode::Kind kind;
+    uint8_t tag;        // BinaryOp, UnaryOp, MiniCType or LiteralNode::LiteralType
+    uint16_t locLength; // length of the node's token
+    uint32_t end;       // index one past the node's last descendant
+    uint32_t data;      // per-kind payload, see FlatAST
+    SourceLoc loc;
+};
+static_assert(sizeof(FlatNode) == 20, "FlatNode is meant to stay packed");
+
+// Name and parameters of an ExternNode or FunctionNode
+struct FlatSignature {
+    Symbol name;
+    uint32_t firstParam; // index into FlatAST::params
+    uint32_t numParams;
+};
+
+// What sema (sema.h) records for one FlatNode
+struct FlatNodeSema {
+    uint32_t ref;        // slot or function index, for the kinds that have one
+    MiniCType exprType;
+};
+
+/**
+ * @brief The AST flattened into one array in pre-order.
+ *
+ * @details A node's children follow it directly: the first child is at
+ * index + 1 and each next one at the previous child's end, so a whole-tree pass
+ * is a forward scan over contiguous memory and following a child is an index
+ * computation instead of a pointer load. Optional children (else branch, return
+ * value, expression of an empty statement, function body) are simply absent.
+ *
+ * FlatNode::data holds, by kind:
+ *   Program, Block        number of leading children that are externs/declarations
+ *   Extern, Function      index into signatures
+ *   VarDecl, Assign,
+ *   Variable, FunctionCall the Symbol of the name
+ *   Literal               the value's bits
+ *
+ * Build one with flattenAST(); walk it through FlatPtr handles, which offer the
+ * same getters as the tree classes so that a visitor can be written once for
+ * both forms (codegen.h). What the tree nodes' sema setters would store goes to
+ * sema, parallel to nodes; it is filled in by sema() and never saved.
+ */
+struct FlatAST {
+    llvm::ArrayRef<FlatNode> nodes;
+    llvm::ArrayRef<FlatSignature> signatures;
+    llvm::ArrayRef<Param> params;
+
+    // The arrays above view either these, for an AST built in memory, or the
+    // mapped file of a loaded one (ast_file.h). Moving keeps the views valid.
+    std::vector<FlatNode> nodeStorage;
+    std::vector<FlatSignature> signatureStorage;
+    std::vector<Param> paramStorage;
+    std::unique_ptr<llvm::MemoryBuffer> file;
+
+    // Annotations on an AST that is otherwise read-only
+    mutable std::vector<FlatNodeSema> sema;
+
+    FlatAST() = default;
+    FlatAST(FlatAST&&) = default;
+    FlatAST& operator=(FlatAST&&) = default;
+    FlatAST(const FlatAST&) = delete;
+    FlatAST& operator=(const FlatAST&) = delete;
+
+    // Points the views at the storage vectors
+    void useStorage() {
+        nodes = nodeStorage;
+        signatures = signatureStorage;
+        params = paramStorage;
+    }
+
+    size_t bytes() const {
+        return nodes.size() * sizeof(FlatNode) + signatures.size() * sizeof(FlatSignature) +
+               params.size() * sizeof(Param);
+    }
+};
+
+// Pre-order copy of the tree below root; the tree can be freed afterwards
+FlatAST flattenAST(const ASTnode* root);
+
+// Token the tree node had, rebuilt from the compact location of node
+TOKEN flatNodeToken(const FlatNode& node);
+
+template <typename T> class FlatPtr;
+class FlatNodeRange;
+
+// What every FlatPtr has, whatever node class it stands for
+class FlatHandle {
+protected:
+    const FlatAST* ast = nullptr;
+    uint32_t index = 0;
+
+    FlatHandle() = default;
+    FlatHandle(const FlatAST* ast, uint32_t index) : ast(ast), index(index) {}
+
+    const FlatNode& node() const { return ast->nodes[index]; }
+    const FlatSignature& signature() const { return ast->signatures[node().data]; }
+    FlatNodeSema& sema() const { return ast->sema[index]; }
+    // Index of this node's child number n, or node().end if it has no more children
+    uint32_t childIndex(uint32_t n) const {
+        uint32_t child = index + 1;
+        for (; n && child != node().end; --n)
+            child = ast->nodes[child].end;
+        return child;
+    }
+    // All children from number n on, and the first count children
+    inline FlatNodeRange children(uint32_t n = 0) const;
+    inline FlatNodeRange leadingChildren(uint32_t count) const;
+    // Child number n, or null when there is none
+    inline FlatPtr<ASTnode> child(uint32_t n) const;
+
+public:
+    ASTnode::Kind getKind() const { return node().kind; }
+    TOKEN getLoc() const { return flatNodeToken(node()); }
+    uint32_t getIndex() const { return index; }
+    MiniCType getExprType() const { return sema().exprType; }
+    void setExprType(MiniCType type) const { sema().exprType = type; }
+    explicit operator bool() const { return ast != nullptr; }
+};
+
+// Getters of the tree class T, specialised below for every class that has any
+template <typename T> class FlatAccessors : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+};
+
+/**
+ * @brief Handle to the node at an index of a FlatAST, viewed as tree class T.
+ *
+ * @details Used like a T*: -> reaches the same getters T has, children come back
+ * as FlatPtr<ASTnode> (null for an absent optional child), and static_cast
+ * converts between node classes. ASTVisitorBase takes FlatPtr as its pointer
+ * template, so visitors run over a FlatAST unchanged.
+ */
+template <typename T> class FlatPtr : public FlatAccessors<T> {
+public:
+    FlatPtr() = default;
+    FlatPtr(std::nullptr_t) {}
+    FlatPtr(const FlatAST* ast, uint32_t index) : FlatAccessors<T>(ast, index) {}
+    // Upcasts are implicit and downcasts need a static_cast, as with T*
+    template <typename U, std::enable_if_t<std::is_base_of<T, U>::value, int> = 0>
+    FlatPtr(const FlatPtr<U>& other) : FlatAccessors<T>(other.ast, other.index) {}
+    template <typename U, std::enable_if_t<!std::is_base_of<T, U>::value, int> = 0>
+    explicit FlatPtr(const FlatPtr<U>& other) : FlatAccessors<T>(other.ast, other.index) {}
+
+    const FlatPtr* operator->() const { return this; }
+
+    template <typename U> friend class FlatPtr;
+};
+
+// Consecutive siblings, iterated by jumping over each one's subtree
+class FlatNodeRange {
+    const FlatAST* ast;
+    uint32_t first;
+    uint32_t last;
+
+public:
+    class iterator {
+        const FlatAST* ast;
+        uint32_t index;
+
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatPtr<ASTnode>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = FlatPtr<ASTnode>;
+
+        iterator(const FlatAST* ast, uint32_t index) : ast(ast), index(index) {}
+        FlatPtr<ASTnode> operator*() const { return FlatPtr<ASTnode>(ast, index); }
+        iterator& operator++() {
+            index = ast->nodes[index].end;
+            return *this;
+        }
+        bool operator==(const iterator& other) const { return index == other.index; }
+        bool operator!=(const iterator& other) const { return index != other.index; }
+    };
+
+    FlatNodeRange(const FlatAST* ast, uint32_t first, uint32_t last) : ast(ast), first(first), last(last) {}
+    iterator begin() const { return {ast, first}; }
+    iterator end() const { return {ast, last}; }
+    bool empty() const { return first == last; }
+    // Walks the range: siblings are not stored contiguously
+    size_t size() const { return std::distance(begin(), end()); }
+};
+
+inline FlatNodeRange FlatHandle::children(uint32_t n) const {
+    return {ast, childIndex(n), node().end};
+}
+
+inline FlatNodeRange FlatHandle::leadingChildren(uint32_t count) const {
+    return {ast, index + 1, childIndex(count)};
+}
+
+inline FlatPtr<ASTnode> FlatHandle::child(uint32_t n) const {
+    uint32_t child = childIndex(n);
+    if (child == node().end)
+        return nullptr;
+    return FlatPtr<ASTnode>(ast, child);
+}
+
+template <> class FlatAccessors<ProgramNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatNodeRange getExterns() const { return leadingChildren(node().data); }
+    FlatNodeRange getDeclarations() const { return children(node().data); }
+};
+
+template <> class FlatAccessors<ExternListNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatNodeRange getExterns() const { return children(); }
+};
+
+template <> class FlatAccessors<DeclListNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatNodeRange getDeclarations() const { return children(); }
+};
+
+template <> class FlatAccessors<ExternNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    MiniCType getType() const { return MiniCType(node().tag); }
+    Symbol getName() const { return signature().name; }
+    llvm::ArrayRef<Param> getParams() const {
+        return ast->params.slice(signature().firstParam, signature().numParams);
+    }
+    uint32_t getFunctionIndex() const { return sema().ref; }
+    void setFunctionIndex(uint32_t index) const { sema().ref = index; }
+};
+
+template <> class FlatAccessors<VarDeclNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    MiniCType getType() const { return MiniCType(node().tag); }
+    Symbol getName() const { return node().data; }
+    uint32_t getSlot() const { return sema().ref; }
+    void setSlot(uint32_t slot) const { sema().ref = slot; }
+};
+
+template <> class FlatAccessors<FunctionNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    MiniCType getReturnType() const { return MiniCType(node().tag); }
+    Symbol getName() const { return signature().name; }
+    llvm::ArrayRef<Param> getParams() const {
+        return ast->params.slice(signature().firstParam, signature().numParams);
+    }
+    FlatPtr<ASTnode> getBody() const { return child(0); }
+    uint32_t getFunctionIndex() const { return sema().ref; }
+    void setFunctionIndex(uint32_t index) const { sema().ref = index; }
+};
+
+template <> class FlatAccessors<TypeNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    MiniCType getType() const { return MiniCType(node().tag); }
+};
+
+template <> class FlatAccessors<BlockNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatNodeRange getDeclarations() const { return leadingChildren(node().data); }
+    FlatNodeRange getStatements() const { return children(node().data); }
+};
+
+template <> class FlatAccessors<IfNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatPtr<ASTnode> getCondition() const { return child(0); }
+    FlatPtr<ASTnode> getThen() const { return child(1); }
+    FlatPtr<ASTnode> getElse() const { return child(2); }
+};
+
+template <> class FlatAccessors<WhileNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatPtr<ASTnode> getCondition() const { return child(0); }
+    FlatPtr<ASTnode> getBody() const { return child(1); }
+};
+
+template <> class FlatAccessors<ReturnNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatPtr<ASTnode> getValue() const { return child(0); }
+};
+
+template <> class FlatAccessors<ExprStmtNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    FlatPtr<ASTnode> getExpr() const { return child(0); }
+};
+
+template <> class FlatAccessors<BinaryOpNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    BinaryOp getOp() const { return BinaryOp(node().tag); }
+    FlatPtr<ASTnode> getLeft() const { return child(0); }
+    FlatPtr<ASTnode> getRight() const { return child(1); }
+};
+
+template <> class FlatAccessors<UnaryOpNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    UnaryOp getOp() const { return UnaryOp(node().tag); }
+    FlatPtr<ASTnode> getOperand() const { return child(0); }
+};
+
+template <> class FlatAccessors<AssignNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    Symbol getName() const { return node().data; }
+    FlatPtr<ASTnode> getValue() const { return child(0); }
+    uint32_t getSlot() const { return sema().ref; }
+    void setSlot(uint32_t slot) const { sema().ref = slot; }
+};
+
+template <> class FlatAccessors<VariableNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    Symbol getName() const { return node().data; }
+    uint32_t getSlot() const { return sema().ref; }
+    void setSlot(uint32_t slot) const { sema().ref = slot; }
+};
+
+template <> class FlatAccessors<FunctionCallNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    Symbol getName() const { return node().data; }
+    FlatNodeRange getArguments() const { return children(); }
+    uint32_t getCallee() const { return sema().ref; }
+    void setCallee(uint32_t index) const { sema().ref = index; }
+};
+
+template <> class FlatAccessors<LiteralNode> : public FlatHandle {
+protected:
+    using FlatHandle::FlatHandle;
+
+public:
+    LiteralNode::LiteralType getLiteralType() const { return LiteralNode::LiteralType(node().tag); }
+    int getInt() const { return int(node().data); }
+    float getFloat() const {
+        float value;
+        std::memcpy(&value, &node().data, sizeof(value));
+        return value;
+    }
+    bool getBool() const { return node().data != 0; }
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef INTERNER_H
+#define INTERNER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Identifier interning.
+ *
+ * @details Every distinct identifier spelling is stored once and named by a 32-bit
+ * Symbol. The lexer interns identifiers as it reads them, so the AST and the codegen
+ * symbol tables compare and hash plain integers; the spelling is only looked up
+ * again for IR value names and diagnostics. Symbol 0 is the empty string and is
+ * used as "no name".
+ *
+ * The table is not locked: lookups may run on any number of threads, but intern()
+ * must not run concurrently with anything else. Lexing therefore stays on one
+ * thread, and the parallel parser only walks an already lexed TokenStream.
+ */
+using Symbol = uint32_t;
+
+inline constexpr Symbol NoSymbol = 0;
+
+// Returns the symbol for s, adding it on first sight
+Symbol intern(std::string_view s);
+
+// Spelling of an interned symbol. The reference stays valid for the whole run.
+const std::string& symbolName(Symbol sym);
+
+#endif
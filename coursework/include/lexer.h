@@ -2,19 +2,12 @@
 #define LEXER_H
 
 #include "tokens.h"
-#include <cstdio>
+#include "simd_scan.h"
 #include <string>
 
-extern FILE *pFile;
-extern std::string currentFilename;  
-extern int lineNo, columnNo;
-extern std::string IdentifierStr;
-extern int IntVal;
-extern bool BoolVal;
-extern float FloatVal;
-extern std::string StringVal;
-extern std::string currentLineContent;
-
+// Points the lexer at the start of a buffer previously loaded into SrcMgr.
+// isa selects the scanning kernels; by default the best the CPU supports.
+void initLexer(unsigned BufferID, ScanISA isa = detectScanISA());
 TOKEN gettok();
 
-#endif
\ No newline at end of file
+#endif
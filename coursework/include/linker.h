@@ -0,0 +1,24 @@
+#ifndef LINKER_H
+#define LINKER_H
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Links objects into an executable with lld, inside the mccomp process.
+ *
+ * @details lld's ELF driver is linked into mccomp and called the way the clang
+ * driver would call ld.lld for a C++ program: crt1.o, crti.o and GCC's
+ * crtbegin.o first, then the inputs, libstdc++, libm, libc and libgcc, and
+ * finally crtend.o and crtn.o. The C runtime objects are looked up in the
+ * directories of LIBRARY_PATH and then in the system library directories. GCC's
+ * objects are looked up in the newest lib/gcc/<triple>/<version> directory
+ * under any of those. Only x86-64 and AArch64 Linux are supported.
+ */
+
+// Links inputs into the executable output for target triple. Returns false with
+// the reason in error on failure; lld's own diagnostics go to stderr.
+bool linkExecutable(const std::string& triple, const std::vector<std::string>& inputs, const std::string& output,
+                    std::string& error);
+
+#endif
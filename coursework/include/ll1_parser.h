@@ -0,0 +1,22 @@
+#ifndef LL1_PARSER_H
+#define LL1_PARSER_H
+
+#include "ast.h"
+
+/**
+ * @brief Table-driven LL(1) parser generated from grammar.txt.
+ *
+ * @details An alternative to the recursive-descent parser in parser.cpp that builds
+ * the same AST. tools/grammar_gen.cpp turns the grammar into ll1_table.h: every
+ * production's right-hand side, including the @actions written in grammar.txt,
+ * and a dense [nonterminal][token] table of the production to expand. The driver
+ * keeps the parse on an explicit stack, so nesting depth is bounded by memory
+ * rather than the C stack, and each action is a hook in ll1_parser.cpp that pops
+ * its operands off a node stack and pushes the node it builds.
+ *
+ * Tokens are read through getNextToken(), so the streaming lexer and the
+ * pre-lexed stream both work. CurTok must hold the first token on entry.
+ */
+ASTnode* parseProgramLL1();
+
+#endif
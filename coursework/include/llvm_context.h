@@ -26,10 +26,13 @@
 #include "llvm/Target/TargetOptions.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Support/SourceMgr.h"
+#include "llvm/ADT/DenseMap.h"
 #include <map>
 #include <string>
 #include <iostream>
 #include "tokens.h"
+#include "interner.h"
+#include "minic_type.h"
 #include <vector>
 #include "llvm/IR/Value.h"
 
@@ -37,42 +40,22 @@ extern llvm::LLVMContext TheContext;
 extern llvm::IRBuilder<> Builder;
 extern std::unique_ptr<llvm::Module> TheModule;
 
-// Symbol tables
-struct VariableInfo {
-    llvm::Value* value;
-    llvm::Type* type;
-    bool isGlobal;
-    TOKEN declLocation;
-};
+// LLVM type of each MiniCType, created once for TheContext
+extern llvm::Type* const LLVMTypes[NumMiniCTypes];
 
-struct FunctionInfo {
-    llvm::Function* function;
-    TOKEN declLocation;
-    std::vector<std::pair<std::string, TOKEN>> paramLocations;
-};
-
-extern std::vector<std::map<std::string, VariableInfo>> NamedValuesStack; //Local variables
-extern std::map<std::string, VariableInfo> GlobalNamedValues;   // Global variables
-extern std::map<std::string, FunctionInfo> FunctionDeclarations;
-
-void pushScope();
-void popScope();
-VariableInfo* findVariable(const std::string& name);
-
-
-inline llvm::Type* getTypeFromStr(const std::string& type) {
-    if (type == "int") return llvm::Type::getInt32Ty(TheContext);
-    if (type == "float") return llvm::Type::getFloatTy(TheContext);
-    if (type == "bool") return llvm::Type::getInt1Ty(TheContext);
-    if (type == "void") return llvm::Type::getVoidTy(TheContext);
-    return nullptr;
+inline llvm::Type* getLLVMType(MiniCType type) {
+    return LLVMTypes[size_t(type)];
 }
 
 llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction, 
                                         const std::string &VarName,
                                         llvm::Type *VarType);
 
-llvm::Value* convertToType(llvm::Value* val, llvm::Type* targetType, 
-                          bool inConditionalContext = false,
-                          const TOKEN& loc = TOKEN());
+// A TargetMachine for a generic CPU of triple, producing position-independent
+// code, or nullptr with the reason in error if LLVM was built without that target
+std::unique_ptr<llvm::TargetMachine> createTargetMachine(const std::string& triple, std::string& error);
+
+// Emits the implicit conversion of val, of MiniC type from, to type to. Which
+// conversions are allowed where is checked by sema (sema.h) beforehand.
+llvm::Value* convertValue(llvm::Value* val, MiniCType from, MiniCType to);
 #endif
\ No newline at end of file
@@ -0,0 +1,43 @@
+#ifndef MINIC_TYPE_H
+#define MINIC_TYPE_H
+
+#include "tokens.h"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief The MiniC types, as carried by declarations in the AST.
+ *
+ * @details The parser maps the type keyword to a MiniCType once; codegen turns it
+ * into an LLVM type with getLLVMType() (llvm_context.h), and the spelling is only
+ * built for the AST dump and diagnostics.
+ */
+enum class MiniCType : uint8_t {
+    Void, Int, Float, Bool,
+};
+
+inline constexpr size_t NumMiniCTypes = size_t(MiniCType::Bool) + 1;
+
+constexpr std::string_view typeName(MiniCType type) {
+    constexpr std::string_view names[NumMiniCTypes] = {"void", "int", "float", "bool"};
+    return names[size_t(type)];
+}
+
+// The type a type_spec token names; tokenType must be in FIRST_type_spec
+constexpr MiniCType typeFromToken(int tokenType) {
+    switch (tokenType) {
+    case INT_TOK:
+        return MiniCType::Int;
+    case FLOAT_TOK:
+        return MiniCType::Float;
+    case BOOL_TOK:
+        return MiniCType::Bool;
+    default:
+        return MiniCType::Void;
+    }
+}
+
+static_assert(typeName(typeFromToken(FLOAT_TOK)) == "float");
+
+#endif
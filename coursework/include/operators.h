@@ -0,0 +1,105 @@
+#ifndef OPERATORS_H
+#define OPERATORS_H
+
+#include "tokens.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/**
+ * @brief Binary operator table driving the precedence-climbing expression parser.
+ *
+ * @details Indexed by token type + 128. Every binary operator is left associative;
+ * a higher precedence binds tighter. Tokens that are not binary operators have
+ * precedence 0, which ends an operand sequence. The levels match the grammar:
+ *
+ *   1  logic_or   "||"
+ *   2  logic_and  "&&"
+ *   3  equality   "==" "!="
+ *   4  relation   "<=" "<" ">=" ">"
+ *   5  additive   "+" "-"
+ *   6  multiply   "*" "/" "%"
+ *
+ * The parser stores the BinaryOp or UnaryOp in the AST; spelling() turns it back
+ * into text for the AST dump and diagnostics.
+ */
+enum class BinaryOp : uint8_t {
+    Or, And,
+    Eq, Ne,
+    Le, Lt, Ge, Gt,
+    Add, Sub,
+    Mul, Div, Mod,
+};
+
+inline constexpr size_t NumBinaryOps = size_t(BinaryOp::Mod) + 1;
+
+enum class UnaryOp : uint8_t {
+    Neg, Not,
+};
+
+inline constexpr std::string_view BinaryOpSpellings[NumBinaryOps] = {
+    "||", "&&", "==", "!=", "<=", "<", ">=", ">", "+", "-", "*", "/", "%",
+};
+
+constexpr std::string_view spelling(BinaryOp op) {
+    return BinaryOpSpellings[size_t(op)];
+}
+
+constexpr std::string_view spelling(UnaryOp op) {
+    return op == UnaryOp::Neg ? "-" : "!";
+}
+
+// "&&" and "||" evaluate their right operand only when it decides the result
+constexpr bool isShortCircuit(BinaryOp op) {
+    return op == BinaryOp::Or || op == BinaryOp::And;
+}
+
+constexpr bool isComparison(BinaryOp op) {
+    return op >= BinaryOp::Eq && op <= BinaryOp::Gt;
+}
+
+struct BinaryOperatorInfo {
+    BinaryOp op = BinaryOp::Or;
+    uint8_t precedence = 0;
+};
+
+inline constexpr int LowestBinaryPrecedence = 1;
+
+constexpr std::array<BinaryOperatorInfo, 256> makeBinaryOperatorTable() {
+    struct Entry {
+        int token;
+        BinaryOp op;
+        uint8_t precedence;
+    };
+    constexpr Entry entries[] = {
+        {OR, BinaryOp::Or, 1},
+        {AND, BinaryOp::And, 2},
+        {EQ, BinaryOp::Eq, 3},       {NE, BinaryOp::Ne, 3},
+        {LE, BinaryOp::Le, 4},       {LT, BinaryOp::Lt, 4},   {GE, BinaryOp::Ge, 4}, {GT, BinaryOp::Gt, 4},
+        {PLUS, BinaryOp::Add, 5},    {MINUS, BinaryOp::Sub, 5},
+        {ASTERIX, BinaryOp::Mul, 6}, {DIV, BinaryOp::Div, 6}, {MOD, BinaryOp::Mod, 6},
+    };
+    std::array<BinaryOperatorInfo, 256> table{};
+    for (const Entry& e : entries)
+        table[e.token + 128] = {e.op, e.precedence};
+    return table;
+}
+
+inline constexpr std::array<BinaryOperatorInfo, 256> BinaryOperators = makeBinaryOperatorTable();
+
+inline constexpr BinaryOperatorInfo NotABinaryOperator{};
+
+// Operator info for a token type; precedence 0 if it is not a binary operator.
+// Single-character tokens above 127 (non-ASCII bytes) fall outside the table.
+constexpr const BinaryOperatorInfo& binaryOperatorInfo(int tokenType) {
+    if (tokenType < -128 || tokenType > 127)
+        return NotABinaryOperator;
+    return BinaryOperators[tokenType + 128];
+}
+
+static_assert(binaryOperatorInfo(ASTERIX).precedence > binaryOperatorInfo(PLUS).precedence);
+static_assert(spelling(binaryOperatorInfo(MOD).op) == "%" && isComparison(binaryOperatorInfo(GE).op));
+static_assert(binaryOperatorInfo(SC).precedence == 0 && binaryOperatorInfo(AND + 256).precedence == 0);
+
+#endif
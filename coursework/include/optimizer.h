@@ -0,0 +1,29 @@
+#ifndef OPTIMIZER_H
+#define OPTIMIZER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "llvm/IR/Module.h"
+
+/**
+ * @brief The -O levels of mccomp, run over the module before it is written.
+ *
+ * @details Each level runs LLVM's default per-module pipeline for it from the
+ * new pass manager's PassBuilder: SROA and mem2reg turn the allocas of
+ * CreateEntryBlockAlloca() into registers, followed by inlining, GVN, LICM and,
+ * from -O2, loop unrolling and vectorization, as clang enables them. The
+ * pipeline is tuned for a generic CPU of the module's target triple, the same
+ * CPU clang compiles the emitted IR for by default. The module's data layout
+ * is set to match. -O0 leaves the module exactly as codegen produced it.
+ */
+enum class OptLevel : uint8_t { O0, O1, O2, O3, Os };
+
+// The level named by the text after "-O": "0" to "3" or "s"; std::nullopt otherwise
+std::optional<OptLevel> parseOptLevel(const char* name);
+
+// Optimizes module at level. Returns false with the reason in error if there is
+// no target for the module's triple.
+bool optimizeModule(llvm::Module& module, OptLevel level, std::string& error);
+
+#endif
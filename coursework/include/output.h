@@ -0,0 +1,37 @@
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+
+/**
+ * @brief What mccomp writes for the module: IR, machine code or a program.
+ *
+ * @details LLVMIR (the default, or --emit-llvm) and Bitcode (--emit-bc) are
+ * written straight from the module. Bitcode may also carry the module summary
+ * index (--module-summary) that ThinLTO's thin link reads in place of the IR.
+ * Assembly (-S) and Object (-c) are emitted in process by a TargetMachine for a
+ * generic CPU of the module's triple, through
+ * TargetMachine::addPassesToEmitFile. Executable (--link=Object) emits the
+ * object to a temporary file and links it with the given objects, such as a
+ * test's compiled driver.cpp, using the embedded lld (linker.h). The compiled
+ * program then goes from .c to a runnable binary in one invocation.
+ */
+enum class OutputKind : uint8_t { LLVMIR, Bitcode, Assembly, Object, Executable };
+
+// Where kind is written when no -o is given: output.ll, output.bc, output.s, output.o or output
+const char* getDefaultOutputFile(OutputKind kind);
+
+// Writes module to os as bitcode, with its module summary index if withSummary
+void writeBitcode(const llvm::Module& module, llvm::raw_ostream& os, bool withSummary);
+
+// Writes module to path ("-" for stdout) as kind; bitcode includes the module
+// summary if moduleSummary, and an executable is linked with linkInputs.
+// Returns false with the reason in error on failure.
+bool writeOutput(llvm::Module& module, OutputKind kind, const std::string& path, bool moduleSummary,
+                 const std::vector<std::string>& linkInputs, std::string& error);
+
+#endif
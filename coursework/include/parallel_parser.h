@@ -0,0 +1,37 @@
+#ifndef PARALLEL_PARSER_H
+#define PARALLEL_PARSER_H
+
+#include "ast.h"
+#include "token_stream.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Parallel parsing of top-level declarations over a pre-lexed stream.
+ *
+ * @details MiniC top-level declarations are independent once their extents are
+ * known. A pre-pass over the token types finds where each extern, global variable
+ * and function starts by matching parentheses and braces. The externs are parsed
+ * on the calling thread; the other declarations are cut into chunks of roughly
+ * equal token counts, parsed concurrently with the recursive-descent parser (whose
+ * token state is per thread) and spliced into the ProgramNode in source order.
+ *
+ * Anything the pre-pass cannot split cleanly is handed to the serial parser, so
+ * malformed input gets exactly the diagnostic a serial parse would give. Errors
+ * inside a chunk are held back until every earlier chunk has parsed, so the error
+ * reported is still the first one in the file. Each thread builds its nodes in a
+ * child of the caller's CurrentArena.
+ */
+struct DeclSplit {
+    size_t externs = 0;        // how many of the declarations are leading externs
+    std::vector<size_t> starts; // first token of each declaration, then the EOF_TOK index
+};
+
+// Finds the top-level declarations of tokens. Returns false if the stream is not
+// a non-empty run of externs followed by declarations with balanced brackets.
+bool splitTopLevelDecls(const TokenStream& tokens, DeclSplit& split);
+
+// Parses the whole of tokens on up to jobs threads; jobs <= 1 parses serially
+ProgramNode* parseProgramParallel(const TokenStream& tokens, unsigned jobs);
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef SCOPED_SYMBOL_TABLE_H
+#define SCOPED_SYMBOL_TABLE_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include "interner.h"
+
+/**
+ * @brief Block-scoped declarations in one hash table, with an undo log.
+ *
+ * @details An open-addressing table with linear probing maps each name to its
+ * innermost visible binding. Every binding links to the one it shadows, so
+ * lookup is one probe sequence however deep the scopes are. The bindings are
+ * kept in a single vector in declaration order, which is also the undo log:
+ * popScope() walks back over the bindings of the innermost scope and restores
+ * each name's link. The cost is proportional to the declarations in that
+ * scope, and no memory is allocated per scope.
+ *
+ * A name's slot is kept after its last binding is popped. The table therefore
+ * only grows with the number of distinct names declared, and needs no
+ * tombstones. The outermost scope, depth 0, is open from the start and holds
+ * the globals. Pointers returned by lookup() are valid until the next
+ * declare().
+ */
+template <typename T>
+class ScopedSymbolTable {
+    static constexpr uint32_t None = UINT32_MAX;
+
+    struct Slot {
+        Symbol name = NoSymbol; // NoSymbol marks an empty slot
+        uint32_t innermost = None;
+    };
+    struct Binding {
+        uint32_t slot;
+        uint32_t shadowed; // binding of the same name in an outer scope, or None
+        uint32_t depth;
+        T value;
+    };
+
+    std::vector<Slot> slots = std::vector<Slot>(64); // power-of-two size
+    uint32_t usedSlots = 0;
+    std::vector<Binding> bindings;
+    std::vector<uint32_t> scopeStarts; // first binding of each scope above depth 0
+
+    // Fibonacci hashing: symbols are small consecutive integers
+    uint32_t home(Symbol name) const {
+        return uint32_t((uint64_t(name) * 0x9E3779B97F4A7C15ull) >> 32) & (slots.size() - 1);
+    }
+
+    // Slot holding name, or the empty slot where it would go
+    uint32_t find(Symbol name) const {
+        uint32_t mask = slots.size() - 1;
+        for (uint32_t i = home(name);; i = (i + 1) & mask) {
+            if (slots[i].name == name || slots[i].name == NoSymbol)
+                return i;
+        }
+    }
+
+    void grow() {
+        std::vector<Slot> old(slots.size() * 2);
+        old.swap(slots);
+        std::vector<uint32_t> moved(old.size());
+        for (uint32_t i = 0; i < old.size(); ++i) {
+            if (old[i].name == NoSymbol)
+                continue;
+            uint32_t slot = find(old[i].name);
+            slots[slot] = old[i];
+            moved[i] = slot;
+        }
+        for (Binding& binding : bindings)
+            binding.slot = moved[binding.slot];
+    }
+
+    const Binding* innermost(Symbol name) const {
+        const Slot& slot = slots[find(name)];
+        return slot.name == name && slot.innermost != None ? &bindings[slot.innermost] : nullptr;
+    }
+
+public:
+    unsigned depth() const { return scopeStarts.size(); }
+
+    void pushScope() { scopeStarts.push_back(bindings.size()); }
+
+    void popScope() {
+        assert(!scopeStarts.empty() && "the global scope is never popped");
+        for (uint32_t first = scopeStarts.back(); bindings.size() > first; bindings.pop_back())
+            slots[bindings.back().slot].innermost = bindings.back().shadowed;
+        scopeStarts.pop_back();
+    }
+
+    // Adds name to the innermost scope, shadowing any outer declaration
+    void declare(Symbol name, const T& value) {
+        if ((usedSlots + 1) * 4 > slots.size() * 3)
+            grow();
+        uint32_t slot = find(name);
+        if (slots[slot].name == NoSymbol) {
+            slots[slot].name = name;
+            ++usedSlots;
+        }
+        bindings.push_back({slot, slots[slot].innermost, depth(), value});
+        slots[slot].innermost = bindings.size() - 1;
+    }
+
+    // The innermost visible declaration of name, or nullptr
+    const T* lookup(Symbol name) const {
+        const Binding* binding = innermost(name);
+        return binding ? &binding->value : nullptr;
+    }
+
+    // The declaration of name in the innermost scope itself, or nullptr
+    const T* lookupInCurrentScope(Symbol name) const {
+        const Binding* binding = innermost(name);
+        return binding && binding->depth == depth() ? &binding->value : nullptr;
+    }
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef SEMA_H
+#define SEMA_H
+
+#include <cstdint>
+#include "ast.h"
+#include "ast_visitor.h"
+#include "flat_ast.h"
+#include "scoped_symbol_table.h"
+#include "llvm/ADT/DenseMap.h"
+
+/**
+ * @brief Semantic analysis: resolves every name and type before code generation.
+ *
+ * @details One pass over the declarations in source order, with the scoping and
+ * diagnostics the code generator used to apply as it went: a name is visible
+ * from its declaration on, a call must follow a declaration of its callee, and
+ * statements after a return in the same block are unreachable and not checked.
+ * Variables live in a ScopedSymbolTable, so resolving a name costs the same at
+ * any nesting depth. Errors are reported with reportError(), which exits, so
+ * only valid programs reach codegen.
+ *
+ * The results are left on the nodes: every expression's type (getExprType()),
+ * the slot of each VarDecl, Variable and Assign (getSlot()), and the function
+ * index of each Extern, Function (getFunctionIndex()) and FunctionCall
+ * (getCallee()). Locals, parameters first, are numbered from 0 within their
+ * function and globals from 0 across the program, marked with GlobalSlotBit.
+ * Each distinct function name gets the next index at its first declaration;
+ * an extern repeating a name gets an index of its own that no call uses.
+ *
+ * Expressions go through ExpressionWalker (ast_visitor.h), so however deeply
+ * they nest they are checked without recursion. Like CodeGenBase, Ptr selects
+ * the tree (Sema) or a FlatAST (FlatSema), whose annotations are kept in
+ * FlatAST::sema.
+ */
+inline constexpr uint32_t GlobalSlotBit = 0x80000000u;
+
+template <template <typename> class Ptr>
+class SemaBase : public ASTVisitorBase<Ptr, SemaBase<Ptr>, MiniCType>,
+                 public ExpressionWalker<Ptr, SemaBase<Ptr>, MiniCType> {
+    friend class ExpressionWalker<Ptr, SemaBase<Ptr>, MiniCType>;
+
+    struct Variable {
+        MiniCType type;
+        uint32_t slot;
+        TOKEN declLocation;
+    };
+    struct Function {
+        uint32_t index;
+        MiniCType returnType;
+        llvm::ArrayRef<Param> params;
+        TOKEN declLocation;
+        bool defined;
+    };
+
+    ScopedSymbolTable<Variable> Variables; // globals at depth 0
+    llvm::DenseMap<Symbol, Function> Functions;
+    uint32_t NumGlobals = 0;
+    uint32_t NumFunctions = 0;
+
+    // The function being checked
+    Symbol FunctionName = NoSymbol;
+    MiniCType ReturnType = MiniCType::Void;
+    uint32_t NumLocals = 0;
+    // Whether the last statement checked returns, so the rest of its block is unreachable
+    bool Returned = false;
+
+    // Reports the error convertToType() would give for an implicit conversion, if any
+    void checkConversion(MiniCType from, MiniCType to, bool inConditionalContext, const TOKEN& loc);
+
+    // Expressions are checked by ExpressionWalker, which calls these
+    void enterExpression(Ptr<ASTnode> node);
+    void exitOperand(Ptr<ASTnode> node, unsigned index, Ptr<ASTnode> operand, MiniCType& type);
+    MiniCType exitExpression(Ptr<ASTnode> node, llvm::ArrayRef<MiniCType> operands);
+    MiniCType checkBinaryOp(Ptr<BinaryOpNode> node, MiniCType L, MiniCType R);
+    MiniCType checkUnaryOp(Ptr<UnaryOpNode> node, MiniCType operand);
+    MiniCType checkAssign(Ptr<AssignNode> node, MiniCType value);
+
+public:
+    using ASTVisitorBase<Ptr, SemaBase<Ptr>, MiniCType>::visit;
+
+    MiniCType visitProgramNode(Ptr<ProgramNode> node);
+    MiniCType visitExternListNode(Ptr<ExternListNode> node);
+    MiniCType visitDeclListNode(Ptr<DeclListNode> node);
+    MiniCType visitExternNode(Ptr<ExternNode> node);
+    MiniCType visitVarDeclNode(Ptr<VarDeclNode> node);
+    MiniCType visitFunctionNode(Ptr<FunctionNode> node);
+    MiniCType visitBlockNode(Ptr<BlockNode> node);
+    MiniCType visitIfNode(Ptr<IfNode> node);
+    MiniCType visitWhileNode(Ptr<WhileNode> node);
+    MiniCType visitReturnNode(Ptr<ReturnNode> node);
+    MiniCType visitExprStmtNode(Ptr<ExprStmtNode> node);
+    MiniCType visitBinaryOpNode(Ptr<BinaryOpNode> node);
+    MiniCType visitUnaryOpNode(Ptr<UnaryOpNode> node);
+    MiniCType visitAssignNode(Ptr<AssignNode> node);
+    MiniCType visitVariableNode(Ptr<VariableNode> node);
+    MiniCType visitFunctionCallNode(Ptr<FunctionCallNode> node);
+    MiniCType visitLiteralNode(Ptr<LiteralNode> node);
+};
+
+using Sema = SemaBase<ASTPtr>;
+using FlatSema = SemaBase<FlatPtr>;
+
+// Checks the program rooted at node and annotates it for codegen
+void sema(ASTnode* node);
+
+// Checks a flattened program, filling in ast.sema
+void sema(const FlatAST& ast);
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef SIMD_SCAN_H
+#define SIMD_SCAN_H
+
+/**
+ * @brief Vectorised scanning kernels for the lexer's long character runs.
+ *
+ * @details Each kernel takes the range [p, end) and returns a pointer to the first
+ * byte that does not continue the run, or end. The SSE2 and AVX2 versions test
+ * 16 or 32 bytes per step and finish the last partial block with the scalar loop,
+ * so they never read past end. The instruction set is chosen at runtime from what
+ * the CPU supports; the scalar kernels are used on every other target.
+ */
+enum class ScanISA { Scalar, SSE2, AVX2 };
+
+struct ScanKernels {
+    const char* (*skipWhitespace)(const char* p, const char* end); // [ \t\n\v\f\r]
+    const char* (*skipIdentifier)(const char* p, const char* end); // [a-zA-Z_0-9]
+    const char* (*skipDigits)(const char* p, const char* end);     // [0-9]
+    const char* (*findLineEnd)(const char* p, const char* end);    // first '\n' or '\r'
+    const char* name;
+};
+
+// Best instruction set the running CPU supports (detected once)
+ScanISA detectScanISA();
+
+// Kernels for isa; falls back to the scalar kernels if isa is unavailable
+const ScanKernels& getScanKernels(ScanISA isa);
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef SOURCE_BUFFER_H
+#define SOURCE_BUFFER_H
+
+#include "tokens.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/SourceMgr.h"
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+/**
+ * @brief Owner of every source file handed to the lexer.
+ *
+ * @details Buffers are loaded through llvm::MemoryBuffer, which mmaps regular files
+ * and falls back to a single bulk read for pipes, standard input and other
+ * non-seekable inputs. They stay alive for the whole compilation so token lexemes
+ * can be views straight into the source text. Buffers are always NUL-terminated one past their end.
+ *
+ * A SourceLoc's fileId is the SrcMgr buffer id. SrcMgr builds each buffer's
+ * line-start offset table lazily on the first line lookup, so nothing is paid
+ * for line information until a diagnostic or AST dump actually needs it.
+ */
+extern llvm::SourceMgr SrcMgr;
+
+// Loads the file at path into SrcMgr; "-" reads standard input to EOF.
+// Returns its buffer id, or 0 and sets EC on failure.
+unsigned loadSourceFile(const std::string& path, std::error_code& EC);
+
+// 1-based line and column of loc, or {0, 0} for an empty location
+std::pair<int, int> getLineAndColumn(SourceLoc loc);
+
+// Text of the line containing loc, without its line terminator
+std::string_view getLineText(SourceLoc loc);
+
+// length bytes of source text starting at loc, cut short at the end of the buffer
+std::string_view getSourceText(SourceLoc loc, size_t length);
+
+// Name of the file loc points into
+std::string_view getFilename(SourceLoc loc);
+
+#endif
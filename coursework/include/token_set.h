@@ -0,0 +1,34 @@
+#ifndef TOKEN_SET_H
+#define TOKEN_SET_H
+
+#include "tokens.h"
+#include <cstdint>
+#include <initializer_list>
+
+/**
+ * @brief A set of token types as a 256-bit bitmap, indexed by token type + 128.
+ *
+ * @details Membership is one shift and mask. The parser's FIRST and FOLLOW sets are
+ * TokenSets generated from grammar.txt (see tools/grammar_gen.cpp and the
+ * generated grammar_sets.h), so they are built at compile time and cannot drift
+ * from the grammar. Token types outside [-128, 127] are never members.
+ */
+struct TokenSet {
+    uint64_t words[4] = {};
+
+    constexpr bool contains(int tokenType) const {
+        unsigned index = static_cast<unsigned>(tokenType + 128);
+        return index < 256 && ((words[index >> 6] >> (index & 63)) & 1);
+    }
+};
+
+constexpr TokenSet makeTokenSet(std::initializer_list<int> tokenTypes) {
+    TokenSet set;
+    for (int type : tokenTypes) {
+        unsigned index = static_cast<unsigned>(type + 128);
+        set.words[index >> 6] |= uint64_t(1) << (index & 63);
+    }
+    return set;
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef TOKEN_STREAM_H
+#define TOKEN_STREAM_H
+
+#include "tokens.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief A whole source buffer lexed up front, stored as parallel arrays.
+ *
+ * @details Token i is described by types[i], offsets[i], lengths[i] and values[i].
+ * The lexeme is not copied: it is recovered from the source buffer through the
+ * offset and length. values holds the bits of a literal's converted value
+ * (int, float or bool) or an identifier's interned Symbol, and is 0 for every
+ * other token. The stream always ends with
+ * a single EOF_TOK, so a parser walking it by index can look ahead any distance
+ * without calling back into the lexer.
+ *
+ * At 14 bytes per token the arrays are less than half the size of the equivalent
+ * std::vector<TOKEN>, and the parser's sequential walk touches each array linearly.
+ */
+struct TokenStream {
+    unsigned bufferId = 0;
+    const char* bufferStart = nullptr;
+
+    std::vector<int16_t> types;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<uint32_t> values;
+
+    size_t size() const { return types.size(); }
+
+    // Rebuilds token i as a TOKEN; indices past the end yield the final EOF_TOK
+    TOKEN get(size_t i) const;
+
+    // Bytes used by the arrays, for memory comparisons with the streaming lexer
+    size_t memoryUsage() const;
+};
+
+// Lexes the whole of a buffer previously loaded into SrcMgr
+TokenStream lexAll(unsigned BufferID);
+
+#endif
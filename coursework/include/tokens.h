@@ -1,7 +1,10 @@
 #ifndef TOKENS_H
 #define TOKENS_H
 
+#include "interner.h"
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 enum TOKEN_TYPE {
 
@@ -63,17 +66,79 @@ enum TOKEN_TYPE {
   INVALID = -100 // signal invalid token
 };
 
+// Keyword spellings and the token type each one lexes to
+struct Keyword {
+    std::string_view spelling;
+    int type = IDENT;
+};
+
+inline constexpr Keyword Keywords[] = {
+    {"int", INT_TOK},   {"void", VOID_TOK}, {"float", FLOAT_TOK}, {"bool", BOOL_TOK},
+    {"extern", EXTERN}, {"if", IF},         {"else", ELSE},       {"while", WHILE},
+    {"return", RETURN}, {"true", BOOL_LIT}, {"false", BOOL_LIT},
+};
+
+// Perfect hash over the keyword set: every keyword gets its own slot of a
+// 16-entry table, so an identifier costs one hash and one compare to classify.
+// Only called on identifiers of at least two characters.
+constexpr unsigned keywordHash(std::string_view s) {
+    return (s.size() + static_cast<unsigned char>(s[0]) * 6u +
+            static_cast<unsigned char>(s[1]) * 7u) & 15u;
+}
+
+struct KeywordTable {
+    Keyword slots[16];
+    bool perfect = true;
+};
+
+constexpr KeywordTable makeKeywordTable() {
+    KeywordTable table{};
+    for (const Keyword& kw : Keywords) {
+        Keyword& slot = table.slots[keywordHash(kw.spelling)];
+        if (!slot.spelling.empty())
+            table.perfect = false;
+        slot = kw;
+    }
+    return table;
+}
+
+inline constexpr KeywordTable KeywordSlots = makeKeywordTable();
+static_assert(KeywordSlots.perfect, "keywordHash must map every keyword to its own slot");
+
+// Returns the token type of s if it is a keyword, IDENT otherwise
+constexpr int lookupKeyword(std::string_view s) {
+    if (s.size() < 2 || s.size() > 6)
+        return IDENT;
+    const Keyword& kw = KeywordSlots.slots[keywordHash(s)];
+    return kw.spelling == s ? kw.type : IDENT;
+}
+
+static_assert(lookupKeyword("while") == WHILE && lookupKeyword("whale") == IDENT);
+
+// Compact source location: the SrcMgr buffer id plus a byte offset into that buffer.
+// Line, column and line text are looked up from the buffer's line table on demand.
+struct SourceLoc {
+    uint32_t fileId = 0; // 0 means no location
+    uint32_t offset = 0;
+};
+
 // TOKEN struct is used to keep track of information about a token
 struct TOKEN {
     int type = -100;
-    std::string lexeme;
-    int lineNo;
-    int columnNo;
-    std::string lineContent;
-    std::string filename;
+    std::string_view lexeme; // view into the source buffer, or a string literal
+    SourceLoc srcLoc;
+    union { // converted value of INT_LIT, FLOAT_LIT and BOOL_LIT tokens, or an IDENT's symbol
+        int intVal = 0;
+        float floatVal;
+        bool boolVal;
+        Symbol symbol;
+    };
+
+    int lineNo() const;
+    int columnNo() const;
 };
 
 // Utility function to create a token
-TOKEN returnTok(std::string lexVal, int tok_type);
+TOKEN returnTok(std::string_view lexVal, int tok_type, SourceLoc loc);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,294 @@
+#include "ast_file.h"
+#include "interner.h"
+#include "source_buffer.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <array>
+#include <cstring>
+#include <vector>
+
+static constexpr char ASTFileMagic[8] = {'M', 'I', 'N', 'I', 'C', 'A', 'S', 'T'};
+
+// Kinds whose FlatNode::data is a Symbol
+static bool namesSymbol(ASTnode::Kind kind) {
+    return kind == ASTnode::Kind::VarDecl || kind == ASTnode::Kind::Assign || kind == ASTnode::Kind::Variable ||
+           kind == ASTnode::Kind::FunctionCall;
+}
+
+static llvm::StringRef sourceText(unsigned sourceId) {
+    return SrcMgr.getMemoryBuffer(sourceId)->getBuffer();
+}
+
+bool writeASTFile(const std::string& path, const FlatAST& ast, unsigned sourceId, std::error_code& EC) {
+    // File-local symbol numbers, in order of first use
+    llvm::DenseMap<Symbol, uint32_t> localIds;
+    std::vector<Symbol> symbols;
+    auto localId = [&](Symbol sym) -> uint32_t {
+        if (sym == NoSymbol)
+            return 0;
+        auto inserted = localIds.try_emplace(sym, symbols.size() + 1);
+        if (inserted.second)
+            symbols.push_back(sym);
+        return inserted.first->second;
+    };
+
+    std::vector<FlatNode> nodes(ast.nodes.begin(), ast.nodes.end());
+    for (FlatNode& node : nodes)
+        if (namesSymbol(node.kind))
+            node.data = localId(node.data);
+    std::vector<FlatSignature> signatures(ast.signatures.begin(), ast.signatures.end());
+    for (FlatSignature& signature : signatures)
+        signature.name = localId(signature.name);
+    // Zeroed first so the padding inside each Param is written as zeros
+    std::vector<Param> params(ast.params.size());
+    std::memset(static_cast<void*>(params.data()), 0, params.size() * sizeof(Param));
+    for (size_t i = 0; i < params.size(); ++i) {
+        params[i].first = ast.params[i].first;
+        params[i].second = localId(ast.params[i].second);
+    }
+
+    ASTFileHeader header{};
+    std::memcpy(header.magic, ASTFileMagic, sizeof(header.magic));
+    header.version = ASTFileVersion;
+    header.sourceFileId = sourceId;
+    header.sourceSize = sourceText(sourceId).size();
+    header.sourceHash = llvm::xxHash64(sourceText(sourceId));
+    header.numNodes = nodes.size();
+    header.numSignatures = signatures.size();
+    header.numParams = params.size();
+    header.numSymbols = symbols.size();
+
+    llvm::raw_fd_ostream out(path, EC, llvm::sys::fs::OF_None);
+    if (EC)
+        return false;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(nodes.data()), nodes.size() * sizeof(FlatNode));
+    out.write(reinterpret_cast<const char*>(signatures.data()), signatures.size() * sizeof(FlatSignature));
+    out.write(reinterpret_cast<const char*>(params.data()), params.size() * sizeof(Param));
+    for (Symbol sym : symbols)
+        out << symbolName(sym) << '\0';
+    out.close();
+    if (out.has_error()) {
+        EC = out.error();
+        out.clear_error();
+        return false;
+    }
+    return true;
+}
+
+static constexpr uint32_t kindBit(ASTnode::Kind kind) {
+    return 1u << uint32_t(kind);
+}
+static_assert(NumASTKinds <= 32, "ChildRule masks hold one bit per kind");
+
+static constexpr uint32_t ExprKinds = kindBit(ASTnode::Kind::BinaryOp) | kindBit(ASTnode::Kind::UnaryOp) |
+                                      kindBit(ASTnode::Kind::Assign) | kindBit(ASTnode::Kind::Variable) |
+                                      kindBit(ASTnode::Kind::FunctionCall) | kindBit(ASTnode::Kind::Literal);
+static constexpr uint32_t StmtKinds = kindBit(ASTnode::Kind::Block) | kindBit(ASTnode::Kind::If) |
+                                      kindBit(ASTnode::Kind::While) | kindBit(ASTnode::Kind::Return) |
+                                      kindBit(ASTnode::Kind::ExprStmt);
+static constexpr uint32_t DeclKinds = kindBit(ASTnode::Kind::Function) | kindBit(ASTnode::Kind::VarDecl);
+
+// The children a node of some kind may have, as the FlatPtr getters expect
+// them: between minChildren and maxChildren of them, the leading ones of the
+// kinds in first and the others of the kinds in rest. Program and Block lead
+// with FlatNode::data externs or declarations; every other kind with one child.
+struct ChildRule {
+    uint32_t minChildren;
+    uint32_t maxChildren;
+    uint32_t first;
+    uint32_t rest;
+};
+
+static constexpr uint32_t AnyNumber = UINT32_MAX;
+
+static constexpr std::array<ChildRule, NumASTKinds> makeChildRules() {
+    std::array<ChildRule, NumASTKinds> rules{};
+    auto set = [&](ASTnode::Kind kind, ChildRule rule) { rules[size_t(kind)] = rule; };
+    set(ASTnode::Kind::Program, {0, AnyNumber, kindBit(ASTnode::Kind::Extern), DeclKinds});
+    set(ASTnode::Kind::ExternList, {0, AnyNumber, kindBit(ASTnode::Kind::Extern), kindBit(ASTnode::Kind::Extern)});
+    set(ASTnode::Kind::DeclList, {0, AnyNumber, DeclKinds, DeclKinds});
+    set(ASTnode::Kind::Function, {0, 1, kindBit(ASTnode::Kind::Block), 0});
+    set(ASTnode::Kind::Block, {0, AnyNumber, kindBit(ASTnode::Kind::VarDecl), StmtKinds});
+    set(ASTnode::Kind::If, {2, 3, ExprKinds, StmtKinds});
+    set(ASTnode::Kind::While, {2, 2, ExprKinds, StmtKinds});
+    set(ASTnode::Kind::Return, {0, 1, ExprKinds, 0});
+    set(ASTnode::Kind::ExprStmt, {0, 1, ExprKinds, 0});
+    set(ASTnode::Kind::BinaryOp, {2, 2, ExprKinds, ExprKinds});
+    set(ASTnode::Kind::UnaryOp, {1, 1, ExprKinds, 0});
+    set(ASTnode::Kind::Assign, {1, 1, ExprKinds, 0});
+    set(ASTnode::Kind::FunctionCall, {0, AnyNumber, ExprKinds, ExprKinds});
+    // Extern, VarDecl, Type, Variable and Literal are leaves
+    return rules;
+}
+
+static constexpr auto ChildRules = makeChildRules();
+
+// Whether the children of nodes[index], whose subtrees are already known to nest
+// properly, are as many and of the kinds its rule allows
+static bool hasValidChildren(llvm::ArrayRef<FlatNode> nodes, uint32_t index) {
+    const FlatNode& node = nodes[index];
+    const ChildRule& rule = ChildRules[size_t(node.kind)];
+    bool leadingCount = node.kind == ASTnode::Kind::Program || node.kind == ASTnode::Kind::Block;
+    uint32_t numFirst = leadingCount ? node.data : 1;
+
+    uint32_t count = 0;
+    for (uint32_t child = index + 1; child != node.end; child = nodes[child].end, ++count) {
+        uint32_t allowed = count < numFirst ? rule.first : rule.rest;
+        if (count >= rule.maxChildren || !(allowed & kindBit(nodes[child].kind)))
+            return false;
+    }
+    return count >= rule.minChildren && (!leadingCount || node.data <= count);
+}
+
+// Whether the arrays form a Program tree that FlatPtr can walk without leaving
+// them: kinds, tags and indices in range, every subtree inside its parent's, and
+// every node with the number and kinds of children its getters expect
+static bool isWellFormed(llvm::ArrayRef<FlatNode> nodes, llvm::ArrayRef<FlatSignature> signatures,
+                         llvm::ArrayRef<Param> params, uint32_t numSymbols, const ASTFileHeader& header) {
+    if (nodes.empty() || nodes[0].kind != ASTnode::Kind::Program || nodes[0].end != nodes.size())
+        return false;
+    for (const FlatSignature& signature : signatures)
+        if (signature.name > numSymbols || uint64_t(signature.firstParam) + signature.numParams > params.size())
+            return false;
+    for (const Param& param : params)
+        if (size_t(param.first) >= NumMiniCTypes || param.second > numSymbols)
+            return false;
+
+    std::vector<uint32_t> openEnds;
+    for (uint32_t i = 0; i < nodes.size(); ++i) {
+        const FlatNode& node = nodes[i];
+        while (!openEnds.empty() && openEnds.back() == i)
+            openEnds.pop_back();
+        if (node.end <= i || (!openEnds.empty() && node.end > openEnds.back()))
+            return false;
+        openEnds.push_back(node.end);
+
+        if (size_t(node.kind) >= NumASTKinds)
+            return false;
+        if (node.loc.fileId != 0 &&
+            (node.loc.fileId != header.sourceFileId || node.loc.offset > header.sourceSize))
+            return false;
+        switch (node.kind) {
+            case ASTnode::Kind::Extern:
+            case ASTnode::Kind::Function:
+                if (node.data >= signatures.size())
+                    return false;
+                [[fallthrough]];
+            case ASTnode::Kind::VarDecl:
+            case ASTnode::Kind::Type:
+                if (node.tag >= NumMiniCTypes)
+                    return false;
+                break;
+            case ASTnode::Kind::BinaryOp:
+                if (node.tag >= NumBinaryOps)
+                    return false;
+                break;
+            case ASTnode::Kind::UnaryOp:
+                if (node.tag > uint8_t(UnaryOp::Not))
+                    return false;
+                break;
+            case ASTnode::Kind::Literal:
+                if (node.tag > uint8_t(LiteralNode::LiteralType::Bool))
+                    return false;
+                break;
+            default:
+                break;
+        }
+        if (namesSymbol(node.kind) && node.data > numSymbols)
+            return false;
+    }
+    for (uint32_t i = 0; i < nodes.size(); ++i)
+        if (!hasValidChildren(nodes, i))
+            return false;
+    return true;
+}
+
+std::optional<FlatAST> readASTFile(const std::string& path, unsigned sourceId, std::string& whyNot) {
+    auto FileOrErr = llvm::MemoryBuffer::getFile(path, /*IsText=*/false, /*RequiresNullTerminator=*/false);
+    if (!FileOrErr) {
+        whyNot = "cannot read " + path + ": " + FileOrErr.getError().message();
+        return std::nullopt;
+    }
+    std::unique_ptr<llvm::MemoryBuffer> file = std::move(*FileOrErr);
+    llvm::StringRef data = file->getBuffer();
+
+    ASTFileHeader header;
+    if (data.size() < sizeof(header)) {
+        whyNot = path + " is not an AST file";
+        return std::nullopt;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, ASTFileMagic, sizeof(header.magic)) != 0) {
+        whyNot = path + " is not an AST file";
+        return std::nullopt;
+    }
+    if (header.version != ASTFileVersion) {
+        whyNot = path + " was written by a different version of mccomp";
+        return std::nullopt;
+    }
+    llvm::StringRef source = sourceText(sourceId);
+    if (header.sourceSize != source.size() || header.sourceHash != llvm::xxHash64(source)) {
+        whyNot = path + " is stale: the source has changed since it was written";
+        return std::nullopt;
+    }
+
+    uint64_t nodesAt = sizeof(header);
+    uint64_t signaturesAt = nodesAt + uint64_t(header.numNodes) * sizeof(FlatNode);
+    uint64_t paramsAt = signaturesAt + uint64_t(header.numSignatures) * sizeof(FlatSignature);
+    uint64_t namesAt = paramsAt + uint64_t(header.numParams) * sizeof(Param);
+    if (namesAt > data.size()) {
+        whyNot = path + " is truncated";
+        return std::nullopt;
+    }
+    llvm::ArrayRef<FlatNode> nodes(reinterpret_cast<const FlatNode*>(data.data() + nodesAt), header.numNodes);
+    llvm::ArrayRef<FlatSignature> signatures(reinterpret_cast<const FlatSignature*>(data.data() + signaturesAt),
+                                             header.numSignatures);
+    llvm::ArrayRef<Param> params(reinterpret_cast<const Param*>(data.data() + paramsAt), header.numParams);
+    if (!isWellFormed(nodes, signatures, params, header.numSymbols, header)) {
+        whyNot = path + " is corrupt";
+        return std::nullopt;
+    }
+
+    // Intern the names; the arrays can be used as they are if every symbol got its file number
+    std::vector<Symbol> symbols = {NoSymbol};
+    bool renumber = false;
+    llvm::StringRef names = data.drop_front(namesAt);
+    for (uint32_t i = 1; i <= header.numSymbols; ++i) {
+        size_t length = names.find('\0');
+        if (length == llvm::StringRef::npos) {
+            whyNot = path + " is truncated";
+            return std::nullopt;
+        }
+        symbols.push_back(intern(std::string_view(names.data(), length)));
+        renumber |= symbols.back() != i;
+        names = names.drop_front(length + 1);
+    }
+
+    FlatAST ast;
+    if (!renumber && header.sourceFileId == sourceId) {
+        ast.nodes = nodes;
+        ast.signatures = signatures;
+        ast.params = params;
+        ast.file = std::move(file);
+        return std::optional<FlatAST>(std::move(ast));
+    }
+
+    ast.nodeStorage.assign(nodes.begin(), nodes.end());
+    for (FlatNode& node : ast.nodeStorage) {
+        if (namesSymbol(node.kind))
+            node.data = symbols[node.data];
+        if (node.loc.fileId != 0)
+            node.loc.fileId = sourceId;
+    }
+    ast.signatureStorage.assign(signatures.begin(), signatures.end());
+    for (FlatSignature& signature : ast.signatureStorage)
+        signature.name = symbols[signature.name];
+    ast.paramStorage.assign(params.begin(), params.end());
+    for (Param& param : ast.paramStorage)
+        param.second = symbols[param.second];
+    ast.useStorage();
+    return std::optional<FlatAST>(std::move(ast));
+}
@@ -0,0 +1,599 @@
+#include "codegen.h"
+#include "llvm_context.h"
+#include "error_handler.h"
+#include <array>
+#include <iostream>
+
+// Stores value at index of a table that grows as sema's numbers are first met
+template <typename T>
+static void setAt(std::vector<T>& table, uint32_t index, const T& value) {
+    if (index >= table.size())
+        table.resize(index + 1);
+    table[index] = value;
+}
+
+Value* codegen(ASTnode* node) {
+    return CodeGen().visit(node);
+}
+
+Value* codegen(const FlatAST& ast) {
+    return FlatCodeGen().visit(FlatPtr<ASTnode>(&ast, 0));
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitProgramNode(Ptr<ProgramNode> node) {
+    for (const auto& ext : node->getExterns()) {
+        if (!visit(ext)) {
+            std::cerr << "Error: Failed to generate code for extern\n";
+            return nullptr;
+        }
+    }
+    
+    for (const auto& decl : node->getDeclarations()) {
+        if (!visit(decl)) {
+            std::cerr << "Error: Failed to generate code for declarationp\n";
+            return nullptr;
+        }
+    }
+    
+    return llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+}
+
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitExternNode(Ptr<ExternNode> node) {
+    std::vector<Type*> ArgTypes;
+    for (const auto& param : node->getParams()) {
+        ArgTypes.push_back(getLLVMType(param.first));
+    }
+    
+    Type* RetType = getLLVMType(node->getType());
+    
+    FunctionType *FT = FunctionType::get(RetType, ArgTypes, false);
+Function *F = Function::Create(
+        FT, 
+        Function::ExternalLinkage,
+        symbolName(node->getName()),
+        TheModule.get()
+    );
+    F->setCallingConv(llvm::CallingConv::C);    
+    setAt(Functions, node->getFunctionIndex(), {F, node->getParams()});
+    // Setting up the parameter names
+    unsigned Idx = 0;
+    for (auto &Arg : F->args()) {
+        Arg.setName(symbolName(node->getParams()[Idx++].second));
+    }
+    
+    return F;
+}
+
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitVarDeclNode(Ptr<VarDeclNode> node) {
+    Symbol name = node->getName();
+    uint32_t slot = node->getSlot();
+
+    llvm::Type* varType = getLLVMType(node->getType());
+
+    if (slot & GlobalSlotBit) {
+        llvm::GlobalVariable* GlobalVar = new llvm::GlobalVariable(
+            *TheModule,
+            varType,
+            false,
+            llvm::GlobalValue::ExternalLinkage,
+            llvm::Constant::getNullValue(varType),
+            symbolName(name)
+        );
+
+        setAt(Globals, slot & ~GlobalSlotBit, GlobalVar);
+        return GlobalVar;
+    }
+
+    llvm::Function* TheFunction = Builder.GetInsertBlock()->getParent();
+    llvm::AllocaInst* Alloca = CreateEntryBlockAlloca(TheFunction, symbolName(name), varType);
+    setAt(Locals, slot, Alloca);
+    return Alloca;
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitFunctionNode(Ptr<FunctionNode> node) {
+    Symbol name = node->getName();
+    llvm::ArrayRef<Param> params = node->getParams();
+    uint32_t index = node->getFunctionIndex();
+
+    std::vector<Type*> ArgTypes;
+    for (const auto& param : params) {
+        ArgTypes.push_back(getLLVMType(param.first));
+    }
+    
+    Type* RetType = getLLVMType(node->getReturnType());
+    
+    // Define the function an earlier extern or prototype declared, if any (important for mutual recursion)
+    Function *F = index < Functions.size() ? Functions[index].function : nullptr;
+    if (!F) {
+        FunctionType *FT = FunctionType::get(RetType, ArgTypes, false);
+        F = Function::Create(FT, Function::ExternalLinkage, symbolName(name), TheModule.get());
+        F->setCallingConv(llvm::CallingConv::C);
+    }
+    setAt(Functions, index, {F, params});
+
+    // A prototype only declares the function, which a later definition fills in
+    if (!node->getBody())
+        return F;
+    
+    BasicBlock *BB = BasicBlock::Create(TheContext, "entry", F);
+    Builder.SetInsertPoint(BB);
+    ReturnType = node->getReturnType();
+    
+    // set up parameters, which take the first local slots
+    Locals.clear();
+    unsigned Idx = 0;
+    for (auto &Arg : F->args()) {
+        Arg.setName(symbolName(params[Idx].second));
+        llvm::Type* paramType = ArgTypes[Idx];
+        AllocaInst *Alloca = CreateEntryBlockAlloca(F, symbolName(params[Idx].second), paramType);
+        Builder.CreateStore(&Arg, Alloca);
+        Locals.push_back(Alloca);
+        Idx++;
+    }
+    
+    if (Value *RetVal = visit(node->getBody())) {
+        // If body doesn't end with a terminator, add one
+        if (!Builder.GetInsertBlock()->getTerminator()) {
+            if (RetType->isVoidTy()) {
+                Builder.CreateRetVoid();
+            } else {
+                Builder.CreateRet(Constant::getNullValue(RetType));
+            }
+        }
+        
+        verifyFunction(*F);
+        return F;
+    } else {
+        std::cerr << "Error: Failed to generate code for function body\n";
+    }
+    
+    F->eraseFromParent();
+    return nullptr;
+}
+
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitBlockNode(Ptr<BlockNode> node) {
+    // An empty block has no code, like an empty statement
+    Value* Last = llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+
+    // decls
+    for (const auto& decl : node->getDeclarations()) {
+        Last = visit(decl);
+        if (!Last) {
+            reportError("Failed to generate code for declaration", decl->getLoc());
+        }
+    }
+
+    // stmts
+    for (const auto& stmt : node->getStatements()) {
+        Last = visit(stmt);
+        if (!Last) {
+            reportError("Failed to generate code for statement", stmt->getLoc());
+        }
+
+        // If block is terminated like hitting a return, break
+        if (Builder.GetInsertBlock()->getTerminator())
+            break;
+    }
+
+    return Last;
+}
+
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitIfNode(Ptr<IfNode> node) {
+    Ptr<ASTnode> elseBlock = node->getElse();
+    const TOKEN& loc = node->getLoc();
+
+    Value *CondV = visit(node->getCondition());
+    if (!CondV) {
+        reportError("Failed to generate code for if condition", loc);
+    }
+
+    // Test the condition as a bool
+    CondV = convertValue(CondV, node->getCondition()->getExprType(), MiniCType::Bool);
+
+    Function *TheFunction = Builder.GetInsertBlock()->getParent();
+    
+    // Create blocks
+    BasicBlock *ThenBB = BasicBlock::Create(TheContext, "then", TheFunction);
+    BasicBlock *MergeBB = BasicBlock::Create(TheContext, "ifcont");
+    
+    // Create else block only if we have an else statement
+    BasicBlock *ElseBB = nullptr;
+    if (elseBlock) {
+        ElseBB = BasicBlock::Create(TheContext, "else");
+    }
+
+    // Insert MergeBB and ElseBB (if it exists) before creating branches
+    if (elseBlock) {
+        ElseBB->insertInto(TheFunction);
+    }
+    MergeBB->insertInto(TheFunction);
+    
+    // Create conditional branch
+    Builder.CreateCondBr(CondV, ThenBB, ElseBB ? ElseBB : MergeBB);
+    
+    // Emit then block
+    Builder.SetInsertPoint(ThenBB);
+    Value *ThenV = visit(node->getThen());
+    if (!ThenV) {
+        reportError("Failed to generate code for then block", loc);
+    }
+    // Add branch to merge block if it doesn't already have a terminator
+    if (!Builder.GetInsertBlock()->getTerminator()) {
+        Builder.CreateBr(MergeBB);
+    }
+    
+    // Emit else block if it exists
+    if (elseBlock) {
+        Builder.SetInsertPoint(ElseBB);
+        Value *ElseV = visit(elseBlock);
+        if (!ElseV) {
+            reportError("Failed to generate code for else block", loc);
+        }
+        // Add branch to merge block if it doesn't already have a terminator
+        if (!Builder.GetInsertBlock()->getTerminator()) {
+            Builder.CreateBr(MergeBB);
+        }
+    }
+    
+    // Set insert point to merge block
+    Builder.SetInsertPoint(MergeBB);
+    
+    return llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitWhileNode(Ptr<WhileNode> node) {
+    const TOKEN& loc = node->getLoc();
+    
+    Function *TheFunction = Builder.GetInsertBlock()->getParent();
+
+    // Create basic blocks for the loop
+    BasicBlock *HeaderBB = BasicBlock::Create(TheContext, "while.header", TheFunction);
+    BasicBlock *BodyBB = BasicBlock::Create(TheContext, "while.body");
+    BasicBlock *ExitBB = BasicBlock::Create(TheContext, "while.exit");
+
+    // Branch from the current block to the header
+    Builder.CreateBr(HeaderBB);
+
+    // Emit the header block
+    Builder.SetInsertPoint(HeaderBB);
+    Value *CondV = visit(node->getCondition());
+    if (!CondV) {
+        reportError("Failed to generate code for while condition", loc);
+    }
+
+    // Test the condition as a bool
+    CondV = convertValue(CondV, node->getCondition()->getExprType(), MiniCType::Bool);
+
+    // Add both BodyBB and ExitBB to the function before creating the conditional branch
+    BodyBB->insertInto(TheFunction);
+    ExitBB->insertInto(TheFunction);
+
+    // Create conditional branch
+    Builder.CreateCondBr(CondV, BodyBB, ExitBB);
+
+    // Emit the body block
+    Builder.SetInsertPoint(BodyBB);
+    if (!visit(node->getBody())) {
+        reportError("Failed to generate code for while body", loc);
+    }
+
+    // Create branch back to header block if the block isn't already terminated
+    if (!Builder.GetInsertBlock()->getTerminator()) {
+        Builder.CreateBr(HeaderBB);
+    }
+
+    // Move to exit block
+    Builder.SetInsertPoint(ExitBB);
+
+    return Constant::getNullValue(Type::getInt32Ty(TheContext));
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitReturnNode(Ptr<ReturnNode> node) {
+    Ptr<ASTnode> value = node->getValue();
+    const TOKEN& loc = node->getLoc();
+
+    Value* RetVal = nullptr;
+    if (value) {
+        RetVal = visit(value);
+        if (!RetVal){
+            reportError("Failed to generate code for return value", loc);
+        }
+
+        // Convert the value to the function's return type
+        RetVal = convertValue(RetVal, value->getExprType(), ReturnType);
+    }
+    
+    return Builder.CreateRet(RetVal);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitExprStmtNode(Ptr<ExprStmtNode> node) {
+    const TOKEN& loc = node->getLoc();
+
+    // An empty statement has no code
+    if (!node->getExpr())
+        return llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+
+    Value* Val = visit(node->getExpr());
+    if (!Val) {
+        reportError("Failed to generate code for expression statement", loc);
+    }
+    // The value is not used further, as it's an expression statement.
+    return Val;
+}
+
+// Emits one arithmetic or comparison instruction on operands already converted
+// to the column's type
+using BinaryEmitter = Value* (*)(Value* L, Value* R);
+
+// Which column of BinaryEmitters applies: float if either operand is a float,
+// otherwise int32 (or i1 for a comparison of two bools)
+enum OperandKind : uint8_t { IntOperands, FloatOperands, NumOperandKinds };
+
+static constexpr std::array<std::array<BinaryEmitter, NumOperandKinds>, NumBinaryOps> makeBinaryEmitters() {
+    std::array<std::array<BinaryEmitter, NumOperandKinds>, NumBinaryOps> table{};
+    auto set = [&](BinaryOp op, BinaryEmitter intEmitter, BinaryEmitter floatEmitter) {
+        table[size_t(op)] = {intEmitter, floatEmitter};
+    };
+    // "&&" and "||" branch instead, so their entries stay empty
+    set(BinaryOp::Add,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateAdd(L, R, "addtmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFAdd(L, R, "addtmp"); });
+    set(BinaryOp::Sub,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateSub(L, R, "subtmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFSub(L, R, "subtmp"); });
+    set(BinaryOp::Mul,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateMul(L, R, "multmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFMul(L, R, "multmp"); });
+    set(BinaryOp::Div,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateSDiv(L, R, "divtmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFDiv(L, R, "divtmp"); });
+    set(BinaryOp::Mod,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateSRem(L, R, "modtmp"); },
+        [](Value*, Value*) -> Value* { llvm_unreachable("sema rejects % on floats"); });
+    set(BinaryOp::Lt,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpSLT(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpOLT(L, R, "cmptmp"); });
+    set(BinaryOp::Le,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpSLE(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpOLE(L, R, "cmptmp"); });
+    set(BinaryOp::Gt,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpSGT(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpOGT(L, R, "cmptmp"); });
+    set(BinaryOp::Ge,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpSGE(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpOGE(L, R, "cmptmp"); });
+    set(BinaryOp::Eq,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpEQ(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpOEQ(L, R, "cmptmp"); });
+    set(BinaryOp::Ne,
+        [](Value* L, Value* R) -> Value* { return Builder.CreateICmpNE(L, R, "cmptmp"); },
+        [](Value* L, Value* R) -> Value* { return Builder.CreateFCmpONE(L, R, "cmptmp"); });
+    return table;
+}
+
+static constexpr auto BinaryEmitters = makeBinaryEmitters();
+
+static constexpr bool hasEveryBinaryEmitter() {
+    for (size_t op = 0; op < NumBinaryOps; ++op)
+        for (BinaryEmitter emitter : BinaryEmitters[op])
+            if (!emitter && !isShortCircuit(BinaryOp(op)))
+                return false;
+    return true;
+}
+static_assert(hasEveryBinaryEmitter(), "every non-short-circuit operator needs an emitter per operand kind");
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitBinaryOpNode(Ptr<BinaryOpNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitUnaryOpNode(Ptr<UnaryOpNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitAssignNode(Ptr<AssignNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitFunctionCallNode(Ptr<FunctionCallNode> node) {
+    return this->walkExpression(node);
+}
+
+// Converts each operand as soon as it is generated, as a condition for "&&" and
+// "||" and to the parameter's type for an argument. Once the left operand of
+// "&&" or "||" is known, it branches to the right operand or straight past it.
+template <template <typename> class Ptr>
+void CodeGenBase<Ptr>::exitOperand(Ptr<ASTnode> node, unsigned index, Ptr<ASTnode> operand, Value*& value) {
+    if (node->getKind() == ASTnode::Kind::FunctionCall) {
+        const DeclaredFunction& callee = Functions[static_cast<Ptr<FunctionCallNode>>(node)->getCallee()];
+        value = convertValue(value, operand->getExprType(), callee.params[index].first);
+        return;
+    }
+    if (node->getKind() != ASTnode::Kind::BinaryOp)
+        return;
+    BinaryOp op = static_cast<Ptr<BinaryOpNode>>(node)->getOp();
+    if (!isShortCircuit(op))
+        return;
+
+    value = convertValue(value, operand->getExprType(), MiniCType::Bool);
+    if (index == 1)
+        return;
+
+    Function* TheFunction = Builder.GetInsertBlock()->getParent();
+
+    // Create blocks but don't insert yet
+    BasicBlock* RHSBlock = BasicBlock::Create(TheContext, "rhs");
+    BasicBlock* MergeBlock = BasicBlock::Create(TheContext, "merge");
+
+    // Store the entry block for PHI
+    ShortCircuits.push_back({Builder.GetInsertBlock(), MergeBlock});
+
+    // Add the blocks to the function
+    TheFunction->insert(TheFunction->end(), RHSBlock);
+    TheFunction->insert(TheFunction->end(), MergeBlock);
+
+    // Create conditional branch based on operator
+    if (op == BinaryOp::And) {
+        Builder.CreateCondBr(value, RHSBlock, MergeBlock);
+    } else { // BinaryOp::Or
+        Builder.CreateCondBr(value, MergeBlock, RHSBlock);
+    }
+
+    // The right operand is emitted in RHS block
+    Builder.SetInsertPoint(RHSBlock);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::exitExpression(Ptr<ASTnode> node, llvm::ArrayRef<Value*> operands) {
+    switch (node->getKind()) {
+        case ASTnode::Kind::BinaryOp:
+            return emitBinaryOp(static_cast<Ptr<BinaryOpNode>>(node), operands[0], operands[1]);
+        case ASTnode::Kind::UnaryOp:
+            return emitUnaryOp(static_cast<Ptr<UnaryOpNode>>(node), operands[0]);
+        case ASTnode::Kind::Assign:
+            return emitAssign(static_cast<Ptr<AssignNode>>(node), operands[0]);
+        case ASTnode::Kind::FunctionCall: {
+            DeclaredFunction callee = Functions[static_cast<Ptr<FunctionCallNode>>(node)->getCallee()];
+            return Builder.CreateCall(callee.function, operands, "calltmp");
+        }
+        default:
+            llvm_unreachable("ExpressionWalker only walks operators, assignments and calls");
+    }
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::emitBinaryOp(Ptr<BinaryOpNode> node, Value* L, Value* R) {
+    BinaryOp op = node->getOp();
+
+    // Lazy evaluation for logical operators: both operands are already bools
+    if (isShortCircuit(op)) {
+        auto [EntryBlock, MergeBlock] = ShortCircuits.back();
+        ShortCircuits.pop_back();
+
+        // Store the RHS end block for PHI
+        BasicBlock* RHSEndBlock = Builder.GetInsertBlock();
+        Builder.CreateBr(MergeBlock);
+
+        // Emit merge block
+        Builder.SetInsertPoint(MergeBlock);
+        PHINode* PN = Builder.CreatePHI(Type::getInt1Ty(TheContext), 2, "logical.result");
+
+        // Adding incoming values for the PHI node
+        if (op == BinaryOp::And) {
+            PN->addIncoming(ConstantInt::getFalse(TheContext), EntryBlock);
+            PN->addIncoming(R, RHSEndBlock);
+        } else {
+            PN->addIncoming(ConstantInt::getTrue(TheContext), EntryBlock);
+            PN->addIncoming(R, RHSEndBlock);
+        }
+
+        return PN;
+    }
+
+    // Bring both operands to the type the operation is done in
+    MiniCType LType = node->getLeft()->getExprType();
+    MiniCType RType = node->getRight()->getExprType();
+    OperandKind kind;
+    if (LType == MiniCType::Float || RType == MiniCType::Float) {
+        kind = FloatOperands;
+        L = convertValue(L, LType, MiniCType::Float);
+        R = convertValue(R, RType, MiniCType::Float);
+    } 
+    else {
+        kind = IntOperands;
+        // For non-float operations, convert to int32 (except when both are bool and doing comparison)
+        bool bothBool = LType == MiniCType::Bool && RType == MiniCType::Bool;
+        
+        if (!bothBool || !isComparison(op)) {
+            L = convertValue(L, LType, MiniCType::Int);
+            R = convertValue(R, RType, MiniCType::Int);
+        }
+    }
+
+    return BinaryEmitters[size_t(op)][kind](L, R);
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::emitUnaryOp(Ptr<UnaryOpNode> node, Value* Val) {
+    MiniCType OperandType = node->getOperand()->getExprType();
+
+    if (node->getOp() == UnaryOp::Not) {
+        // Test the operand as a bool since we're doing logical operation
+        Value* BoolVal = convertValue(Val, OperandType, MiniCType::Bool);
+        
+        // Perform the logical NOT
+        return Builder.CreateNot(BoolVal, "not");
+    }
+
+    // For negation, determine target type based on input
+    if (OperandType == MiniCType::Float) {
+        return Builder.CreateFNeg(Val, "neg");
+    }
+    // For any integer type (including bool), convert to int32 first
+    Value* IntVal = convertValue(Val, OperandType, MiniCType::Int);
+    return Builder.CreateNeg(IntVal, "neg");
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::emitAssign(Ptr<AssignNode> node, Value* Val) {
+    // Convert to the variable's type, which is the assignment's
+    Val = convertValue(Val, node->getValue()->getExprType(), node->getExprType());
+
+    Builder.CreateStore(Val, slotAddress(node->getSlot()));
+    return Val;
+}
+
+// VariableNode
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitVariableNode(Ptr<VariableNode> node) {
+    return Builder.CreateLoad(getLLVMType(node->getExprType()), slotAddress(node->getSlot()),
+                              symbolName(node->getName()));
+}
+// LiteralNode
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitLiteralNode(Ptr<LiteralNode> node) {
+    switch (node->getLiteralType()) {
+        case LiteralNode::LiteralType::Int:
+            return llvm::ConstantInt::get(TheContext, llvm::APInt(32, node->getInt(), true)); // 'true' for signed
+        case LiteralNode::LiteralType::Float:
+            return llvm::ConstantFP::get(TheContext, llvm::APFloat(node->getFloat()));
+        case LiteralNode::LiteralType::Bool:
+            return llvm::ConstantInt::get(TheContext, llvm::APInt(1, node->getBool()));
+        default:
+            reportError("Unknown literal type", node->getLoc());
+    }
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitExternListNode(Ptr<ExternListNode> node) {
+    for (const auto& ext : node->getExterns()) {
+        if (!visit(ext))
+            reportError("Failed to generate code for extern", ext->getLoc());
+    }
+    return llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+}
+
+template <template <typename> class Ptr>
+Value* CodeGenBase<Ptr>::visitDeclListNode(Ptr<DeclListNode> node) {
+    for (const auto& decl : node->getDeclarations()) {
+        if (!visit(decl))
+            reportError("Failed to generate code for declaration", decl->getLoc());
+    }
+    return llvm::ConstantInt::get(TheContext, llvm::APInt(32, 0));
+}
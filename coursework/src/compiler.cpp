@@ -0,0 +1,106 @@
+#include "compiler.h"
+#include <optional>
+#include "ast_arena.h"
+#include "ast_file.h"
+#include "codegen.h"
+#include "flat_ast.h"
+#include "ll1_parser.h"
+#include "lexer.h"
+#include "llvm_context.h"
+#include "parallel_parser.h"
+#include "parser.h"
+#include "sema.h"
+#include "source_buffer.h"
+#include "token_stream.h"
+#include "llvm/ADT/ScopeExit.h"
+
+std::unique_ptr<llvm::Module> compileModule(const char* inputFile, const CompileOptions& options, std::string& error) {
+    std::error_code EC;
+    unsigned BufferID = loadSourceFile(inputFile, EC);
+    if (!BufferID) {
+        error = "Error opening file: " + EC.message();
+        return nullptr;
+    }
+
+    // A saved AST that is still current replaces lexing and parsing altogether
+    std::optional<FlatAST> flat;
+    if (options.loadASTFile) {
+        std::string whyNot;
+        flat = readASTFile(options.loadASTFile, BufferID, whyNot);
+        if (!flat)
+            llvm::errs() << "note: not using the saved AST: " << whyNot << "\n";
+    }
+
+    // Run the parser and get the AST. The tree lives in this compile's arena and
+    // is freed with it in one go.
+    ASTArena arena;
+    CurrentArena = &arena;
+    ASTnode* ast = nullptr;
+    TokenStream tokens;
+    // The tokens and the arena go with this frame, on every way out of it
+    auto forgetFrame = llvm::make_scope_exit([] {
+        usePrelexedTokens(nullptr);
+        CurrentArena = nullptr;
+    });
+    if (!flat) {
+        bool parallel = options.jobs > 1 && !options.ll1;
+        if (options.prelex || parallel) {
+            tokens = lexAll(BufferID);
+            usePrelexedTokens(&tokens);
+        } else {
+            usePrelexedTokens(nullptr);
+            initLexer(BufferID);
+        }
+
+        // get the first token
+        getNextToken();
+
+        if (options.ll1)
+            ast = parseProgramLL1();
+        else if (parallel)
+            ast = parseProgramParallel(tokens, options.jobs);
+        else
+            ast = parser();
+        if (!ast) {
+            error = "Failed to generate AST";
+            return nullptr;
+        }
+        dumpAST(ast, options.dumpStream ? *options.dumpStream : llvm::outs(), options.dumpFormat);
+
+        if (options.flatAST || options.emitASTFile)
+            flat = flattenAST(ast);
+        if (options.emitASTFile && !writeASTFile(options.emitASTFile, *flat, BufferID, EC)) {
+            error = "Could not write AST file: " + EC.message();
+            return nullptr;
+        }
+    }
+
+    // Resolve names and types; errors exit from here
+    if (flat)
+        sema(*flat);
+    else
+        sema(ast);
+    if (options.checkOnly)
+        return nullptr;
+
+    // Make the module, which holds all the code
+    TheModule = std::make_unique<llvm::Module>("mini-c", TheContext);
+
+    //Set the target triple
+    TheModule->setTargetTriple(llvm::sys::getDefaultTargetTriple());
+
+    // Generate code from the AST
+    llvm::Value* result = flat ? codegen(*flat) : codegen(ast);
+    if (!result) {
+        // The code generator has said why
+        return nullptr;
+    }
+
+    std::string optError;
+    if (!optimizeModule(*TheModule, options.optLevel, optError)) {
+        error = "Could not optimize: " + optError;
+        return nullptr;
+    }
+
+    return std::move(TheModule);
+}
@@ -1,7 +1,15 @@
 #include "error_handler.h"
 #include "llvm/Support/raw_ostream.h"
-#include "lexer.h"
+#include "source_buffer.h"
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
+#include <mutex>
+
+thread_local void (*BeforeReportError)() = nullptr;
+
+// Only one thread may print a diagnostic and exit
+static std::mutex ReportMutex;
 
 /**
 * @brief Main / Core error reporting function used for both semantic and syntax errors in the parser and codegen
@@ -29,6 +37,8 @@
 * - Carets: Green for main error, Cyan for notes
 *
 * @note Function is marked [[noreturn]] as it calls exit(1) meaning I don't need ot call nullptr and segfault to quit the program
+* Safe to call from several threads: the first caller prints its error and exits,
+* and the others block.
 */
 [[noreturn]] void reportError(const std::string& message, 
                              const TOKEN& token,
@@ -36,31 +46,39 @@
                              const Note* note,
                              const CaretPosition* mainCaret,
                              const CaretPosition* noteCaret) {
-    
+    if (BeforeReportError)
+        BeforeReportError();
+    ReportMutex.lock();
+
     llvm::errs().enable_colors(withHighlighting);
 
+    // Line information is only resolved here, once a diagnostic is actually printed
+    auto [lineNo, columnNo] = getLineAndColumn(token.srcLoc);
+    std::string_view filename = getFilename(token.srcLoc);
+    std::string_view lineContent = getLineText(token.srcLoc);
+
     // Main error message
     if (withHighlighting) {
         llvm::errs().changeColor(llvm::raw_ostream::SAVEDCOLOR, true)
-                    << "\033[1m" << token.filename << ":" << token.lineNo 
-                    << ":" << token.columnNo << "\033[0m: ";
+                    << "\033[1m" << filename << ":" << lineNo 
+                    << ":" << columnNo << "\033[0m: ";
         
         llvm::errs().changeColor(llvm::raw_ostream::RED, true) << "error: ";
         llvm::errs().resetColor() << "\033[1m" << message << "\033[0m\n";
     } else {
-        llvm::errs() << token.filename << ":" << token.lineNo << ":" 
-                     << token.columnNo << ": error: " << message << "\n";
+        llvm::errs() << filename << ":" << lineNo << ":" 
+                     << columnNo << ": error: " << message << "\n";
     }
 
-    if (!token.lineContent.empty()) {
-        llvm::errs() << "    " << token.lineNo << " | " << token.lineContent << "\n";
+    if (!lineContent.empty()) {
+        llvm::errs() << "    " << lineNo << " | " << lineContent << "\n";
         llvm::errs() << "      | ";
         
         if (withHighlighting) {
             llvm::errs().changeColor(llvm::raw_ostream::GREEN, true);
         }
         
-        int caretCol = mainCaret ? mainCaret->column : token.columnNo;
+        int caretCol = mainCaret ? mainCaret->column : columnNo;
         
         llvm::errs() << std::string(caretCol - 1, ' ') << "^";
         
@@ -76,27 +94,31 @@
 
     // Additional note to be used to show function and variable definitions similar to clang
     if (note) {
+        auto [noteLineNo, noteColumnNo] = getLineAndColumn(note->location.srcLoc);
+        std::string_view noteFilename = getFilename(note->location.srcLoc);
+        std::string_view noteLineContent = getLineText(note->location.srcLoc);
+
         if (withHighlighting) {
             llvm::errs().changeColor(llvm::raw_ostream::SAVEDCOLOR, true)
-                        << note->location.filename << ":" << note->location.lineNo 
-                        << ":" << note->location.columnNo << ": ";
+                        << noteFilename << ":" << noteLineNo 
+                        << ":" << noteColumnNo << ": ";
             llvm::errs().changeColor(llvm::raw_ostream::CYAN, true) << "note: ";
             llvm::errs().resetColor() << note->message << "\n";
         } else {
-            llvm::errs() << note->location.filename << ":" << note->location.lineNo 
-                        << ":" << note->location.columnNo << ": note: " 
+            llvm::errs() << noteFilename << ":" << noteLineNo 
+                        << ":" << noteColumnNo << ": note: " 
                         << note->message << "\n";
         }
-        if (!note->location.lineContent.empty()) {
-            llvm::errs() << "    " << note->location.lineNo << " | " 
-                        << note->location.lineContent << "\n";
+        if (!noteLineContent.empty()) {
+            llvm::errs() << "    " << noteLineNo << " | " 
+                        << noteLineContent << "\n";
             llvm::errs() << "      | ";
             
             if (withHighlighting) {
                 llvm::errs().changeColor(llvm::raw_ostream::CYAN, true);
             }
             
-            int caretCol = noteCaret ? noteCaret->column : note->location.columnNo;
+            int caretCol = noteCaret ? noteCaret->column : noteColumnNo;
             
             llvm::errs() << std::string(caretCol - 1, ' ') << "^";
             
@@ -113,5 +135,11 @@
     }
 
     llvm::errs() << "1 error generated.\n";
+    if (BeforeReportError) {
+        // Other parser threads may still be reading the source buffers, which
+        // exit() would destroy under them
+        std::fflush(nullptr);
+        std::_Exit(1);
+    }
     exit(1);
 }
\ No newline at end of file
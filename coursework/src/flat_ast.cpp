@@ -0,0 +1,172 @@
+#include "flat_ast.h"
+#include "ast_visitor.h"
+#include "source_buffer.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include <algorithm>
+#include <limits>
+
+TOKEN flatNodeToken(const FlatNode& node) {
+    TOKEN token;
+    token.srcLoc = node.loc;
+    token.lexeme = getSourceText(node.loc, node.locLength);
+    return token;
+}
+
+// Appends every node ahead of its children, then sets its end once they are in
+class ASTFlattener : public ConstASTVisitor<ASTFlattener> {
+    FlatAST& flat;
+
+    uint32_t append(const ASTnode* node, uint8_t tag = 0, uint32_t data = 0) {
+        size_t length = std::min<size_t>(node->loc.lexeme.size(), std::numeric_limits<uint16_t>::max());
+        flat.nodeStorage.push_back({node->getKind(), tag, uint16_t(length), 0, data, node->loc.srcLoc});
+        return flat.nodeStorage.size() - 1;
+    }
+
+    void close(uint32_t index) { flat.nodeStorage[index].end = flat.nodeStorage.size(); }
+
+    // Missing children are left out; FlatPtr reports them as null
+    void visitChildren(llvm::ArrayRef<ASTnode*> children) {
+        for (const ASTnode* child : children)
+            visitChild(child);
+    }
+    void visitChild(const ASTnode* child) {
+        if (child)
+            visit(child);
+    }
+
+    // Operators, assignments and calls may nest too deeply to recurse, so they
+    // are appended from a stack of the nodes still to go; a null node stands
+    // for closing the node at index once its children are in
+    void flattenExpression(const ASTnode* root) {
+        llvm::SmallVector<std::pair<const ASTnode*, uint32_t>, 16> work{{root, 0}};
+        while (!work.empty()) {
+            auto [node, index] = work.pop_back_val();
+            if (!node) {
+                close(index);
+            } else if (auto* binary = llvm::dyn_cast<BinaryOpNode>(node)) {
+                work.push_back({nullptr, append(node, uint8_t(binary->getOp()))});
+                work.push_back({binary->getRight(), 0});
+                work.push_back({binary->getLeft(), 0});
+            } else if (auto* unary = llvm::dyn_cast<UnaryOpNode>(node)) {
+                work.push_back({nullptr, append(node, uint8_t(unary->getOp()))});
+                work.push_back({unary->getOperand(), 0});
+            } else if (auto* assign = llvm::dyn_cast<AssignNode>(node)) {
+                work.push_back({nullptr, append(node, 0, assign->getName())});
+                work.push_back({assign->getValue(), 0});
+            } else if (auto* call = llvm::dyn_cast<FunctionCallNode>(node)) {
+                work.push_back({nullptr, append(node, 0, call->getName())});
+                for (const ASTnode* argument : llvm::reverse(call->getArguments()))
+                    work.push_back({argument, 0});
+            } else {
+                visit(node);
+            }
+        }
+    }
+
+    uint32_t addSignature(Symbol name, llvm::ArrayRef<Param> params) {
+        flat.signatureStorage.push_back({name, uint32_t(flat.paramStorage.size()), uint32_t(params.size())});
+        flat.paramStorage.insert(flat.paramStorage.end(), params.begin(), params.end());
+        return flat.signatureStorage.size() - 1;
+    }
+
+public:
+    explicit ASTFlattener(FlatAST& flat) : flat(flat) {}
+
+    void visitProgramNode(const ProgramNode* node) {
+        uint32_t index = append(node, 0, node->getExterns().size());
+        visitChildren(node->getExterns());
+        visitChildren(node->getDeclarations());
+        close(index);
+    }
+    void visitExternListNode(const ExternListNode* node) {
+        uint32_t index = append(node);
+        visitChildren(node->getExterns());
+        close(index);
+    }
+    void visitDeclListNode(const DeclListNode* node) {
+        uint32_t index = append(node);
+        visitChildren(node->getDeclarations());
+        close(index);
+    }
+    void visitExternNode(const ExternNode* node) {
+        uint32_t index = append(node, uint8_t(node->getType()), addSignature(node->getName(), node->getParams()));
+        close(index);
+    }
+    void visitVarDeclNode(const VarDeclNode* node) {
+        uint32_t index = append(node, uint8_t(node->getType()), node->getName());
+        close(index);
+    }
+    void visitFunctionNode(const FunctionNode* node) {
+        uint32_t index =
+            append(node, uint8_t(node->getReturnType()), addSignature(node->getName(), node->getParams()));
+        visitChild(node->getBody());
+        close(index);
+    }
+    void visitTypeNode(const TypeNode* node) {
+        uint32_t index = append(node, uint8_t(node->getType()));
+        close(index);
+    }
+    void visitBlockNode(const BlockNode* node) {
+        uint32_t index = append(node, 0, node->getDeclarations().size());
+        visitChildren(node->getDeclarations());
+        visitChildren(node->getStatements());
+        close(index);
+    }
+    void visitIfNode(const IfNode* node) {
+        uint32_t index = append(node);
+        visitChild(node->getCondition());
+        visitChild(node->getThen());
+        visitChild(node->getElse());
+        close(index);
+    }
+    void visitWhileNode(const WhileNode* node) {
+        uint32_t index = append(node);
+        visitChild(node->getCondition());
+        visitChild(node->getBody());
+        close(index);
+    }
+    void visitReturnNode(const ReturnNode* node) {
+        uint32_t index = append(node);
+        visitChild(node->getValue());
+        close(index);
+    }
+    void visitExprStmtNode(const ExprStmtNode* node) {
+        uint32_t index = append(node);
+        visitChild(node->getExpr());
+        close(index);
+    }
+    void visitBinaryOpNode(const BinaryOpNode* node) { flattenExpression(node); }
+    void visitUnaryOpNode(const UnaryOpNode* node) { flattenExpression(node); }
+    void visitAssignNode(const AssignNode* node) { flattenExpression(node); }
+    void visitVariableNode(const VariableNode* node) {
+        uint32_t index = append(node, 0, node->getName());
+        close(index);
+    }
+    void visitFunctionCallNode(const FunctionCallNode* node) { flattenExpression(node); }
+    void visitLiteralNode(const LiteralNode* node) {
+        uint32_t bits = 0;
+        switch (node->getLiteralType()) {
+            case LiteralNode::LiteralType::Int:
+                bits = uint32_t(node->getInt());
+                break;
+            case LiteralNode::LiteralType::Float: {
+                float value = node->getFloat();
+                std::memcpy(&bits, &value, sizeof(bits));
+                break;
+            }
+            case LiteralNode::LiteralType::Bool:
+                bits = node->getBool();
+                break;
+        }
+        uint32_t index = append(node, uint8_t(node->getLiteralType()), bits);
+        close(index);
+    }
+};
+
+FlatAST flattenAST(const ASTnode* root) {
+    FlatAST flat;
+    ASTFlattener(flat).visit(root);
+    flat.useStorage();
+    return flat;
+}
@@ -0,0 +1,25 @@
+#include "interner.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringRef.h"
+#include <deque>
+
+// Spellings indexed by symbol. A deque never moves its elements, so the lookup
+// table below can key on views of these strings.
+static std::deque<std::string> SymbolNames = {""};
+static llvm::DenseMap<llvm::StringRef, Symbol> SymbolIds = {{SymbolNames.front(), NoSymbol}};
+
+Symbol intern(std::string_view s) {
+    auto It = SymbolIds.find(llvm::StringRef(s.data(), s.size()));
+    if (It != SymbolIds.end())
+        return It->second;
+
+    // Key on the stored copy; s may be a view into a temporary
+    const std::string& stored = SymbolNames.emplace_back(s);
+    Symbol sym = static_cast<Symbol>(SymbolNames.size() - 1);
+    SymbolIds.try_emplace(stored, sym);
+    return sym;
+}
+
+const std::string& symbolName(Symbol sym) {
+    return SymbolNames[sym];
+}
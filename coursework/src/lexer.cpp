@@ -1,279 +1,220 @@
 #include "lexer.h"
-#include <cctype>
-#include <vector>
-
-FILE *pFile;
-int lineNo = 1, columnNo = 1;
-std::string IdentifierStr;
-int IntVal;
-bool BoolVal;
-float FloatVal;
-std::string currentLineContent;
-std::string currentFilename;
-long lineStartPos = 0;
-
-// tracking the current line content and passing it into TOKEN which is used for the errorHandler and AST node printing
-void updateCurrentLine() {
-    long currentPos = ftell(pFile);
-    fseek(pFile, lineStartPos, SEEK_SET);
-    
-    currentLineContent.clear();
-    int c;
-    while ((c = getc(pFile)) != EOF && c != '\n' && c != '\r') {
-        currentLineContent += (char)c;
-    }
-    
-    // Handle \r\n
-    if (c == '\r') {
-        if ((c = getc(pFile)) != '\n') {
-            ungetc(c, pFile);
-        }
-    }
-    
-    fseek(pFile, currentPos, SEEK_SET);
+#include "source_buffer.h"
+#include "error_handler.h"
+#include "simd_scan.h"
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <string_view>
+
+// Scanning cursor into the current source buffer. The buffer is NUL-terminated,
+// so character-class loops stop at BufferEnd without an explicit bounds check.
+// The cursor is per thread, like the parser's token state.
+static thread_local unsigned CurBufferID = 0;
+static thread_local const char *BufferStart = nullptr;
+static thread_local const char *BufferEnd = nullptr;
+static thread_local const char *CurPtr = nullptr;
+
+// Whitespace, comment, identifier and digit runs are skipped with these kernels
+static thread_local const ScanKernels *Scan = &getScanKernels(ScanISA::Scalar);
+
+void initLexer(unsigned BufferID, ScanISA isa) {
+    const llvm::MemoryBuffer *Buffer = SrcMgr.getMemoryBuffer(BufferID);
+    Scan = &getScanKernels(isa);
+    CurBufferID = BufferID;
+    CurPtr = BufferStart = Buffer->getBufferStart();
+    BufferEnd = Buffer->getBufferEnd();
 }
 
-TOKEN gettok() {
-    static int LastChar = ' ';
-    static int NextChar = ' ';
-    static int lastLineNo = 0;
-
-    // Handle whitespace and track line starts
-    while (isspace(LastChar)) {
-        if (LastChar == '\n' || LastChar == '\r') {
-            lineNo++;
-            columnNo = 1;
-            lineStartPos = ftell(pFile);  // Mark start of new line
-            currentLineContent.clear();    // Clear for new line
-            
-            // Handle \r\n if needed
-            if (LastChar == '\r') {
-                LastChar = getc(pFile);
-                if (LastChar != '\n') {
-                    ungetc(LastChar, pFile);
-                    LastChar = '\r';
-                }
-            }
-        }
-        LastChar = getc(pFile);
-        columnNo++;
-    }
-
-    // Update line content when needed
-    if (lineNo != lastLineNo || currentLineContent.empty()) {
-      updateCurrentLine();
-      lastLineNo = lineNo;
-    }
-
-
-  if (isalpha(LastChar) || (LastChar == '_')) { // identifier: [a-zA-Z_][a-zA-Z_0-9]*
-    IdentifierStr = LastChar;
-    columnNo++;
-
-    while (isalnum((LastChar = getc(pFile))) || (LastChar == '_')) {
-      IdentifierStr += LastChar;
-      columnNo++;
-    }
-
-    if (IdentifierStr == "int")
-      return returnTok("int", INT_TOK);
-    if (IdentifierStr == "bool")
-      return returnTok("bool", BOOL_TOK);
-    if (IdentifierStr == "float")
-      return returnTok("float", FLOAT_TOK);
-    if (IdentifierStr == "void")
-      return returnTok("void", VOID_TOK);
-    if (IdentifierStr == "extern")
-      return returnTok("extern", EXTERN);
-    if (IdentifierStr == "if")
-      return returnTok("if", IF);
-    if (IdentifierStr == "else")
-      return returnTok("else", ELSE);
-    if (IdentifierStr == "while")
-      return returnTok("while", WHILE);
-    if (IdentifierStr == "return")
-      return returnTok("return", RETURN);
-    if (IdentifierStr == "true") {
-      BoolVal = true;
-      return returnTok("true", BOOL_LIT);
-    }
-    if (IdentifierStr == "false") {
-      BoolVal = false;
-      return returnTok("false", BOOL_LIT);
-    }
-
-    return returnTok(IdentifierStr.c_str(), IDENT);
-  }
-
-  if (LastChar == '=') {
-    NextChar = getc(pFile);
-    if (NextChar == '=') { // EQ: ==
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok("==", EQ);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok("=", ASSIGN);
-    }
-  }
-
-  if (LastChar == '{') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok("{", LBRA);
-  }
-  if (LastChar == '}') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok("}", RBRA);
-  }
-  if (LastChar == '(') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok("(", LPAR);
-  }
-  if (LastChar == ')') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok(")", RPAR);
-  }
-  if (LastChar == ';') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok(";", SC);
-  }
-  if (LastChar == ',') {
-    LastChar = getc(pFile);
-    columnNo++;
-    return returnTok(",", COMMA);
-  }
-
-  if (isdigit(LastChar) || LastChar == '.') { // Number: [0-9]+.
-    std::string NumStr;
+// Builds the token starting at TokStart and ending at CurPtr. Only the buffer
+// offset is recorded; line and column are resolved from SrcMgr when needed.
+static TOKEN makeTok(const char *TokStart, int tok_type) {
+    SourceLoc loc{CurBufferID, static_cast<uint32_t>(TokStart - BufferStart)};
+    return returnTok(std::string_view(TokStart, CurPtr - TokStart), tok_type, loc);
+}
 
-    if (LastChar == '.') { // Floatingpoint Number: .[0-9]+
-      do {
-        NumStr += LastChar;
-        LastChar = getc(pFile);
-        columnNo++;
-      } while (isdigit(LastChar));
+//===----------------------------------------------------------------------===//
+// Character classes and token DFA
+//===----------------------------------------------------------------------===//
+
+enum CharClass : uint8_t {
+  CC_Other, // single-character tokens and anything unrecognised
+  CC_Space,
+  CC_Newline,
+  CC_Alpha, // [a-zA-Z_]
+  CC_Digit,
+  CC_Dot,
+  CC_Eq,
+  CC_Bang,
+  CC_Less,
+  CC_Greater,
+  CC_Amp,
+  CC_Pipe,
+  CC_Slash,
+  NumCharClasses
+};
+
+constexpr std::array<uint8_t, 256> makeCharClasses() {
+  std::array<uint8_t, 256> classes{};
+  for (int c = 'a'; c <= 'z'; ++c) classes[c] = CC_Alpha;
+  for (int c = 'A'; c <= 'Z'; ++c) classes[c] = CC_Alpha;
+  for (int c = '0'; c <= '9'; ++c) classes[c] = CC_Digit;
+  classes['_'] = CC_Alpha;
+  classes[' '] = classes['\t'] = classes['\v'] = classes['\f'] = CC_Space;
+  classes['\n'] = classes['\r'] = CC_Newline;
+  classes['.'] = CC_Dot;
+  classes['='] = CC_Eq;
+  classes['!'] = CC_Bang;
+  classes['<'] = CC_Less;
+  classes['>'] = CC_Greater;
+  classes['&'] = CC_Amp;
+  classes['|'] = CC_Pipe;
+  classes['/'] = CC_Slash;
+  return classes;
+}
 
-      FloatVal = strtof(NumStr.c_str(), nullptr);
-      return returnTok(NumStr, FLOAT_LIT);
-    } else {
-      do { // Start of Number: [0-9]+
-        NumStr += LastChar;
-        LastChar = getc(pFile);
-        columnNo++;
-      } while (isdigit(LastChar));
+static constexpr std::array<uint8_t, 256> CharClasses = makeCharClasses();
+
+static inline uint8_t classOf(char c) { return CharClasses[static_cast<unsigned char>(c)]; }
+
+// DFA states. Every state except Start and Stop accepts; lexing follows the
+// transition table until it hits Stop, which gives maximal munch.
+enum LexState : uint8_t {
+  S_Start,
+  S_Ident,
+  S_Int,
+  S_Float,
+  S_Assign,
+  S_Not,
+  S_Less,
+  S_Greater,
+  S_Amp,
+  S_Pipe,
+  S_Div,
+  S_Eq,
+  S_Ne,
+  S_Le,
+  S_Ge,
+  S_And,
+  S_Or,
+  S_Single,
+  S_Comment,
+  NumLexStates,
+  S_Stop = NumLexStates
+};
+
+using TransitionTable = std::array<std::array<uint8_t, NumCharClasses>, NumLexStates>;
+
+constexpr TransitionTable makeTransitions() {
+  TransitionTable table{};
+  for (auto &row : table)
+    for (auto &next : row)
+      next = S_Stop;
+
+  auto &start = table[S_Start];
+  for (auto &next : start)
+    next = S_Single;
+  start[CC_Alpha] = S_Ident;
+  start[CC_Digit] = S_Int;
+  start[CC_Dot] = S_Float;
+  start[CC_Eq] = S_Assign;
+  start[CC_Bang] = S_Not;
+  start[CC_Less] = S_Less;
+  start[CC_Greater] = S_Greater;
+  start[CC_Amp] = S_Amp;
+  start[CC_Pipe] = S_Pipe;
+  start[CC_Slash] = S_Div;
+
+  table[S_Ident][CC_Alpha] = S_Ident;   // identifier: [a-zA-Z_][a-zA-Z_0-9]*
+  table[S_Ident][CC_Digit] = S_Ident;
+  table[S_Int][CC_Digit] = S_Int;       // Integer : [0-9]+
+  table[S_Int][CC_Dot] = S_Float;       // Floatingpoint Number: [0-9]+.[0-9]*
+  table[S_Float][CC_Digit] = S_Float;   // Floatingpoint Number: .[0-9]*
+  table[S_Assign][CC_Eq] = S_Eq;        // EQ: ==
+  table[S_Not][CC_Eq] = S_Ne;           // NE: !=
+  table[S_Less][CC_Eq] = S_Le;          // LE: <=
+  table[S_Greater][CC_Eq] = S_Ge;       // GE: >=
+  table[S_Amp][CC_Amp] = S_And;         // AND: &&
+  table[S_Pipe][CC_Pipe] = S_Or;        // OR: ||
+  table[S_Div][CC_Slash] = S_Comment;   // comment runs to the end of the line
+  return table;
+}
 
-      if (LastChar == '.') { // Floatingpoint Number: [0-9]+.[0-9]+)
-        do {
-          NumStr += LastChar;
-          LastChar = getc(pFile);
-          columnNo++;
-        } while (isdigit(LastChar));
+static constexpr TransitionTable Transitions = makeTransitions();
 
-        FloatVal = strtof(NumStr.c_str(), nullptr);
-        return returnTok(NumStr, FLOAT_LIT);
-      } else { // Integer : [0-9]+
-        IntVal = strtod(NumStr.c_str(), nullptr);
-        return returnTok(NumStr, INT_LIT);
-      }
-    }
-  }
+// Token type accepted in each state. Single-character tokens use the character
+// itself and identifiers are reclassified through the keyword table.
+static constexpr int AcceptedType[NumLexStates] = {
+    INVALID, IDENT,   INT_LIT, FLOAT_LIT, ASSIGN, NOT, LT, GT,      int('&'), int('|'),
+    DIV,     EQ,      NE,      LE,        GE,     AND, OR, INVALID, INVALID,
+};
 
-  if (LastChar == '&') {
-    NextChar = getc(pFile);
-    if (NextChar == '&') { // AND: &&
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok("&&", AND);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok("&", int('&'));
-    }
-  }
+TOKEN gettok() {
+  const char *TokStart;
+  uint8_t State;
 
-  if (LastChar == '|') {
-    NextChar = getc(pFile);
-    if (NextChar == '|') { // OR: ||
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok("||", OR);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok("|", int('|'));
-    }
-  }
+  for (;;) {
+    // Skip whitespace. Line starts are not tracked here: SrcMgr derives them
+    // from the buffer when a location is first resolved.
+    CurPtr = Scan->skipWhitespace(CurPtr, BufferEnd);
 
-  if (LastChar == '!') {
-    NextChar = getc(pFile);
-    if (NextChar == '=') { // NE: !=
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok("!=", NE);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok("!", NOT);
-    }
-  }
+    TokStart = CurPtr;
 
-  if (LastChar == '<') {
-    NextChar = getc(pFile);
-    if (NextChar == '=') { // LE: <=
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok("<=", LE);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok("<", LT);
+    // Check for end of file.  Don't eat the EOF.
+    if (CurPtr == BufferEnd) {
+      SourceLoc loc{CurBufferID, static_cast<uint32_t>(TokStart - BufferStart)};
+      return returnTok("0", EOF_TOK, loc);
     }
-  }
 
-  if (LastChar == '>') {
-    NextChar = getc(pFile);
-    if (NextChar == '=') { // GE: >=
-      LastChar = getc(pFile);
-      columnNo += 2;
-      return returnTok(">=", GE);
-    } else {
-      LastChar = NextChar;
-      columnNo++;
-      return returnTok(">", GT);
+    State = S_Start;
+    for (;;) {
+      uint8_t Next = Transitions[State][classOf(*CurPtr)];
+      if (Next == S_Stop)
+        break;
+      State = Next;
+      ++CurPtr;
+
+      // Long identifier and digit runs are consumed a whole vector at a time
+      if (State == S_Ident)
+        CurPtr = Scan->skipIdentifier(CurPtr, BufferEnd);
+      else if (State == S_Int || State == S_Float)
+        CurPtr = Scan->skipDigits(CurPtr, BufferEnd);
     }
-  }
-
-  if (LastChar == '/') { // could be division or could be the start of a comment
-    LastChar = getc(pFile);
-    columnNo++;
-    if (LastChar == '/') { // definitely a comment
-      do {
-        LastChar = getc(pFile);
-        columnNo++;
-      } while (LastChar != EOF && LastChar != '\n' && LastChar != '\r');
-
-      if (LastChar != EOF)
-        return gettok();
-    } else
-      return returnTok("/", DIV);
-  }
 
-  // Check for end of file.  Don't eat the EOF.
-  if (LastChar == EOF) {
-    columnNo++;
-    return returnTok("0", EOF_TOK);
+    if (State != S_Comment)
+      break;
+    CurPtr = Scan->findLineEnd(CurPtr, BufferEnd);
+  }
+
+  switch (State) {
+  case S_Ident: {
+    TOKEN tok = makeTok(TokStart, lookupKeyword(std::string_view(TokStart, CurPtr - TokStart)));
+    if (tok.type == IDENT)
+      tok.symbol = intern(tok.lexeme);
+    else if (tok.type == BOOL_LIT)
+      tok.boolVal = (*TokStart == 't');
+    return tok;
+  }
+  case S_Single:
+    // Otherwise, just return the character as its ascii value.
+    return makeTok(TokStart, static_cast<unsigned char>(*TokStart));
+  case S_Int: {
+    TOKEN tok = makeTok(TokStart, INT_LIT);
+    auto [End, Err] = std::from_chars(TokStart, CurPtr, tok.intVal);
+    if (Err == std::errc::result_out_of_range)
+      reportError("integer literal '" + std::string(tok.lexeme) + "' is too large for type 'int'", tok);
+    return tok;
+  }
+  case S_Float: {
+    TOKEN tok = makeTok(TokStart, FLOAT_LIT);
+    tok.floatVal = 0.0f; // a lone "." converts to zero, as strtof would
+    auto [End, Err] = std::from_chars(TokStart, CurPtr, tok.floatVal);
+    if (Err == std::errc::result_out_of_range) // overflow to inf / underflow to zero like strtof
+      tok.floatVal = strtof(std::string(tok.lexeme).c_str(), nullptr);
+    return tok;
+  }
+  default:
+    return makeTok(TokStart, AcceptedType[State]);
   }
-
-  // Otherwise, just return the character as its ascii value.
-  int ThisChar = LastChar;
-  std::string s(1, ThisChar);
-  LastChar = getc(pFile);
-  columnNo++;
-  return returnTok(s, int(ThisChar));
-}
\ No newline at end of file
+}
@@ -0,0 +1,127 @@
+#include "linker.h"
+#include <cstdlib>
+#include "lld/Common/Driver.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VersionTuple.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/TargetParser/Triple.h"
+
+LLD_HAS_DRIVER(elf)
+
+// LIBRARY_PATH, which environment modules set for a compiler they provide,
+// then the system directories
+static std::vector<std::string> getLibraryDirs(const llvm::Triple& triple) {
+    std::vector<std::string> dirs;
+    if (const char* libraryPath = getenv("LIBRARY_PATH")) {
+        llvm::SmallVector<llvm::StringRef, 8> parts;
+        llvm::StringRef(libraryPath).split(parts, ':', -1, false);
+        for (llvm::StringRef dir : parts)
+            dirs.push_back(dir.str());
+    }
+    std::string multiarch = triple.getArchName().str() + "-linux-gnu";
+    dirs.push_back("/usr/lib/" + multiarch);
+    dirs.push_back("/lib/" + multiarch);
+    for (const char* dir : {"/usr/lib64", "/lib64", "/usr/lib", "/lib"})
+        dirs.push_back(dir);
+    return dirs;
+}
+
+// Path of name in the first of dirs that has it, or "" if none does
+static std::string findFile(const std::vector<std::string>& dirs, const char* name) {
+    for (const std::string& dir : dirs) {
+        llvm::SmallString<256> path(dir);
+        llvm::sys::path::append(path, name);
+        if (llvm::sys::fs::exists(path))
+            return std::string(path);
+    }
+    return "";
+}
+
+// The lib/gcc/<triple>/<version> directory with the highest version for the
+// architecture of triple that holds crtbegin.o, or "" if there is none
+static std::string findGCCDir(const std::vector<std::string>& dirs, const llvm::Triple& triple) {
+    std::string best;
+    llvm::VersionTuple bestVersion;
+    for (const std::string& dir : dirs) {
+        llvm::SmallString<256> gccDir(dir);
+        llvm::sys::path::append(gccDir, "gcc");
+        std::error_code EC;
+        llvm::sys::fs::directory_iterator end;
+        for (llvm::sys::fs::directory_iterator target(gccDir, EC); !EC && target != end; target.increment(EC)) {
+            if (llvm::Triple(llvm::sys::path::filename(target->path())).getArch() != triple.getArch())
+                continue;
+            std::error_code versionEC;
+            for (llvm::sys::fs::directory_iterator version(target->path(), versionEC); !versionEC && version != end;
+                 version.increment(versionEC)) {
+                llvm::VersionTuple number;
+                if (number.tryParse(llvm::sys::path::filename(version->path())) ||
+                    (!best.empty() && number <= bestVersion))
+                    continue;
+                llvm::SmallString<256> crtbegin(version->path());
+                llvm::sys::path::append(crtbegin, "crtbegin.o");
+                if (llvm::sys::fs::exists(crtbegin)) {
+                    best = version->path();
+                    bestVersion = number;
+                }
+            }
+        }
+    }
+    return best;
+}
+
+bool linkExecutable(const std::string& tripleName, const std::vector<std::string>& inputs, const std::string& output,
+                    std::string& error) {
+    llvm::Triple triple(tripleName);
+    const char* emulation;
+    const char* dynamicLinker;
+    if (triple.isOSLinux() && triple.getArch() == llvm::Triple::x86_64) {
+        emulation = "elf_x86_64";
+        dynamicLinker = "/lib64/ld-linux-x86-64.so.2";
+    } else if (triple.isOSLinux() && triple.getArch() == llvm::Triple::aarch64) {
+        emulation = "aarch64linux";
+        dynamicLinker = "/lib/ld-linux-aarch64.so.1";
+    } else {
+        error = "linking is not supported for " + tripleName;
+        return false;
+    }
+
+    std::vector<std::string> libraryDirs = getLibraryDirs(triple);
+    std::string gccDir = findGCCDir(libraryDirs, triple);
+    if (gccDir.empty()) {
+        error = "could not find GCC's crtbegin.o under lib/gcc in LIBRARY_PATH or the system directories";
+        return false;
+    }
+    // GCC's own libstdc++ and libgcc come before the system's
+    libraryDirs.insert(libraryDirs.begin(), gccDir);
+    std::string crt1 = findFile(libraryDirs, "crt1.o");
+    std::string crti = findFile(libraryDirs, "crti.o");
+    std::string crtn = findFile(libraryDirs, "crtn.o");
+    if (crt1.empty() || crti.empty() || crtn.empty()) {
+        error = "could not find the C runtime's crt1.o, crti.o and crtn.o; add their directory to LIBRARY_PATH";
+        return false;
+    }
+
+    std::vector<std::string> args = {"ld.lld", "-o", output, "--eh-frame-hdr", "-m", emulation,
+                                     "-dynamic-linker", dynamicLinker, crt1, crti, gccDir + "/crtbegin.o"};
+    for (const std::string& dir : libraryDirs)
+        args.push_back("-L" + dir);
+    args.insert(args.end(), inputs.begin(), inputs.end());
+    for (const char* library : {"-lstdc++", "-lm", "-lgcc_s", "-lgcc", "-lc", "-lgcc_s", "-lgcc"})
+        args.push_back(library);
+    args.push_back(gccDir + "/crtend.o");
+    args.push_back(crtn);
+
+    std::vector<const char*> argv;
+    for (const std::string& arg : args)
+        argv.push_back(arg.c_str());
+    lld::Result result = lld::lldMain(argv, llvm::outs(), llvm::errs(), {{lld::Gnu, &lld::elf::link}});
+    if (result.retCode != 0) {
+        error = "lld could not link " + output;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,238 @@
+#include "ll1_parser.h"
+#include "ll1_table.h"
+#include "parser.h"
+#include "operators.h"
+#include "error_handler.h"
+#include <string>
+#include <utility>
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+
+// Stack heights saved by @mark; the action that closes the list pops everything above them
+struct Mark {
+    size_t nodes;
+    size_t tokens;
+};
+
+static thread_local std::vector<int16_t> ParseStack;
+static thread_local std::vector<ASTnode*> Nodes;
+static thread_local std::vector<TOKEN> Tokens;
+static thread_local std::vector<Mark> Marks;
+static thread_local TOKEN PrevTok; // last terminal matched
+
+static ASTnode* popNode() {
+    ASTnode* node = Nodes.back();
+    Nodes.pop_back();
+    return node;
+}
+
+static TOKEN popToken() {
+    TOKEN tok = Tokens.back();
+    Tokens.pop_back();
+    return tok;
+}
+
+static Mark popMark() {
+    Mark mark = Marks.back();
+    Marks.pop_back();
+    return mark;
+}
+
+// Nodes pushed since mark, in source order, copied into the arena
+static llvm::ArrayRef<ASTnode*> popNodes(const Mark& mark) {
+    auto nodes = arenaArray(llvm::ArrayRef<ASTnode*>(Nodes).drop_front(mark.nodes));
+    Nodes.resize(mark.nodes);
+    return nodes;
+}
+
+// Each param leaves its type and name tokens above the mark
+static llvm::ArrayRef<Param> popParams(const Mark& mark) {
+    llvm::SmallVector<Param, 8> params;
+    for (size_t i = mark.tokens; i + 1 < Tokens.size(); i += 2)
+        params.emplace_back(typeFromToken(Tokens[i].type), Tokens[i + 1].symbol);
+    Tokens.resize(mark.tokens);
+    return arenaArray<Param>(params);
+}
+
+// The current token as diagnostics quote it
+static std::string describeCurTok() {
+    if (CurTok.type == EOF_TOK)
+        return ll1TerminalSpelling(EOF_TOK);
+    return "'" + std::string(CurTok.lexeme) + "'";
+}
+
+[[noreturn]] static void reportUnexpected(LL1Nonterminal nt) {
+    std::string expected;
+    int count = 0;
+    for (int type = -128; type < 128; ++type) {
+        if (LL1Table[nt][type + 128] == LL1NoProduction)
+            continue;
+        expected += (count++ ? ", " : "") + std::string(ll1TerminalSpelling(type));
+    }
+    reportError("Unexpected " + describeCurTok() + " in " +
+                LL1NonterminalNames[nt] + ", expected " + (count > 1 ? "one of " : "") + expected,
+                CurTok);
+}
+
+// Runs the semantic action hook named @action in grammar.txt
+static void runAction(LL1Action action) {
+    switch (action) {
+    case ACTION_token:
+        Tokens.push_back(CurTok);
+        break;
+    case ACTION_mark:
+        Marks.push_back({Nodes.size(), Tokens.size()});
+        break;
+    case ACTION_none:
+        Nodes.push_back(nullptr);
+        break;
+    case ACTION_program: {
+        auto declarations = popNodes(popMark());
+        auto externs = popNodes(popMark());
+        Nodes.push_back(newNode<ProgramNode>(externs, declarations, popToken()));
+        break;
+    }
+    case ACTION_extern: {
+        auto params = popParams(popMark());
+        TOKEN name = popToken();
+        TOKEN type = popToken();
+        TOKEN loc = popToken();
+        Nodes.push_back(newNode<ExternNode>(typeFromToken(type.type), name.symbol, params, loc));
+        break;
+    }
+    case ACTION_function: {
+        auto body = popNode();
+        auto params = popParams(popMark());
+        TOKEN name = popToken();
+        TOKEN type = popToken();
+        Nodes.push_back(newNode<FunctionNode>(typeFromToken(type.type), name.symbol, params, body, name));
+        break;
+    }
+    case ACTION_var_decl: {
+        TOKEN name = popToken();
+        TOKEN type = popToken();
+        Nodes.push_back(newNode<VarDeclNode>(typeFromToken(type.type), name.symbol, name));
+        break;
+    }
+    case ACTION_block: {
+        auto statements = popNodes(popMark());
+        auto declarations = popNodes(popMark());
+        Nodes.push_back(newNode<BlockNode>(declarations, statements, popToken()));
+        break;
+    }
+    case ACTION_expr_stmt: {
+        auto expr = popNode();
+        Nodes.push_back(newNode<ExprStmtNode>(expr, popToken()));
+        break;
+    }
+    case ACTION_empty_stmt:
+        Nodes.push_back(newNode<ExprStmtNode>(nullptr));
+        break;
+    case ACTION_while: {
+        auto body = popNode();
+        auto condition = popNode();
+        Nodes.push_back(newNode<WhileNode>(condition, body, popToken()));
+        break;
+    }
+    case ACTION_if: {
+        auto elseBlock = popNode();
+        auto thenBlock = popNode();
+        auto condition = popNode();
+        Nodes.push_back(newNode<IfNode>(condition, thenBlock, elseBlock, popToken()));
+        break;
+    }
+    case ACTION_return: {
+        auto value = popNode();
+        Nodes.push_back(newNode<ReturnNode>(value, popToken()));
+        break;
+    }
+    case ACTION_assign_target: {
+        // The left operand is a lone variable exactly when the token just matched
+        // is an identifier and it is also where that operand's node starts
+        const TOKEN& lhs = Nodes.back()->loc;
+        if (PrevTok.type != IDENT || lhs.srcLoc.fileId != PrevTok.srcLoc.fileId ||
+            lhs.srcLoc.offset != PrevTok.srcLoc.offset) {
+            reportError("Left-hand side of assignment must be a variable", CurTok);
+        }
+        break;
+    }
+    case ACTION_assign: {
+        auto value = popNode();
+        TOKEN name = popNode()->loc;
+        Nodes.push_back(newNode<AssignNode>(name.symbol, value, name));
+        break;
+    }
+    case ACTION_binary: {
+        auto right = popNode();
+        auto left = popNode();
+        TOKEN op = popToken();
+        Nodes.push_back(newNode<BinaryOpNode>(binaryOperatorInfo(op.type).op, left, right, op));
+        break;
+    }
+    case ACTION_unary: {
+        auto operand = popNode();
+        TOKEN op = popToken();
+        Nodes.push_back(newNode<UnaryOpNode>(op.type == MINUS ? UnaryOp::Neg : UnaryOp::Not, operand, op));
+        break;
+    }
+    case ACTION_literal: {
+        TOKEN lit = popToken();
+        if (lit.type == INT_LIT)
+            Nodes.push_back(newNode<LiteralNode>(lit.intVal, lit));
+        else if (lit.type == FLOAT_LIT)
+            Nodes.push_back(newNode<LiteralNode>(lit.floatVal, lit));
+        else
+            Nodes.push_back(newNode<LiteralNode>(lit.boolVal, lit));
+        break;
+    }
+    case ACTION_call: {
+        auto args = popNodes(popMark());
+        TOKEN name = popToken();
+        Nodes.push_back(newNode<FunctionCallNode>(name.symbol, args, name));
+        break;
+    }
+    case ACTION_variable: {
+        TOKEN name = popToken();
+        Nodes.push_back(newNode<VariableNode>(name.symbol, name));
+        break;
+    }
+    case NumLL1Actions:
+        break;
+    }
+}
+
+ASTnode* parseProgramLL1() {
+    ParseStack.clear();
+    Nodes.clear();
+    Tokens.clear();
+    Marks.clear();
+    ParseStack.push_back(EOF_TOK + 128);
+    ParseStack.push_back(LL1NonterminalBase + NT_program);
+
+    while (!ParseStack.empty()) {
+        int16_t symbol = ParseStack.back();
+        ParseStack.pop_back();
+
+        if (symbol < LL1NonterminalBase) {
+            if (CurTok.type + 128 != symbol) {
+                reportError(std::string("Expected ") + ll1TerminalSpelling(symbol - 128) + ", got " +
+                            describeCurTok(), CurTok);
+            }
+            PrevTok = CurTok;
+            if (CurTok.type != EOF_TOK)
+                getNextToken();
+        } else if (symbol < LL1ActionBase) {
+            LL1Nonterminal nt = static_cast<LL1Nonterminal>(symbol - LL1NonterminalBase);
+            unsigned lookahead = static_cast<unsigned>(CurTok.type + 128);
+            uint8_t production = lookahead < 256 ? LL1Table[nt][lookahead] : LL1NoProduction;
+            if (production == LL1NoProduction)
+                reportUnexpected(nt);
+            const LL1Production& rhs = LL1Productions[production];
+            ParseStack.insert(ParseStack.end(), LL1Symbols + rhs.begin, LL1Symbols + rhs.end);
+        } else {
+            runAction(static_cast<LL1Action>(symbol - LL1ActionBase));
+        }
+    }
+
+    return popNode();
+}
@@ -1,10 +1,15 @@
 #include "llvm_context.h"
-#include "error_handler.h"
 
+llvm::LLVMContext TheContext;
+llvm::IRBuilder<> Builder(TheContext);
+std::unique_ptr<llvm::Module> TheModule;
 
-std::map<std::string, FunctionInfo> FunctionDeclarations;
-std::vector<std::map<std::string, VariableInfo>> NamedValuesStack = {{}};
-
+llvm::Type* const LLVMTypes[NumMiniCTypes] = {
+    llvm::Type::getVoidTy(TheContext),
+    llvm::Type::getInt32Ty(TheContext),
+    llvm::Type::getFloatTy(TheContext),
+    llvm::Type::getInt1Ty(TheContext),
+};
 
 llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
                                         const std::string &VarName,
@@ -14,105 +19,34 @@ llvm::AllocaInst *CreateEntryBlockAlloca(llvm::Function *TheFunction,
     return TmpB.CreateAlloca(VarType, nullptr, VarName);
 }
 
-llvm::Value* convertToType(llvm::Value* val, llvm::Type* targetType, 
-                          bool inConditionalContext, const TOKEN& loc) {
-    if (!val || !targetType) return nullptr;
-
-    llvm::Type* sourceType = val->getType();
-    if (sourceType == targetType) return val;
-
-    // Widening conversions (always allowed):
-    
-    // 1. Bool to Int conversion
-    if (sourceType->isIntegerTy(1) && targetType->isIntegerTy(32)) {
-        // When widening bool to int, true becomes 1 and false becomes 0
-        return Builder.CreateZExt(val, targetType, "bool_to_int");
-    }
-    
-    // 2. Bool to Float conversion
-    if (sourceType->isIntegerTy(1) && targetType->isFloatTy()) {
-        // First convert bool to int, then int to float
-        auto intVal = Builder.CreateZExt(val, llvm::Type::getInt32Ty(TheContext), "bool_to_int");
-        return Builder.CreateSIToFP(intVal, targetType, "int_to_float");
-    }
-    
-    // 3. Int to Float conversion
-    if (sourceType->isIntegerTy(32) && targetType->isFloatTy()) {
-        return Builder.CreateSIToFP(val, targetType, "int_to_float");
-    }
-
-    // Special case: Converting to Bool in conditional contexts
-    if (targetType->isIntegerTy(1)) {
-        if (inConditionalContext) {
-            if (sourceType->isIntegerTy()) {
-                // For ints, non-zero is true
-                return Builder.CreateICmpNE(val, 
-                    llvm::ConstantInt::get(sourceType, 0), "int_to_bool");
-            }
-            if (sourceType->isFloatTy()) {
-                // For floats, non-zero is true
-                return Builder.CreateFCmpONE(val,
-                    llvm::ConstantFP::get(sourceType, 0.0), "float_to_bool");
-            }
-        } else {
-            std::string sourceTypeName = sourceType->isIntegerTy() ? "int" :
-                                   sourceType->isFloatTy() ? "float" :
-                                   sourceType->isIntegerTy(1) ? "bool" :
-                                   "unknown";
-            Note note{
-            "narrowing conversions are not allowed in return statements and function calls",
-            loc 
-        };
-        
-        reportError("Cannot convert from '" + sourceTypeName + "' to 'bool' outside conditional context", 
-                   loc, true, &note);
-        }
-    }
-
-    // For all other cases, report an error
-    std::string sourceTypeName = sourceType->isIntegerTy() ? "int" :
-                                 sourceType->isFloatTy() ? "float" :
-                                 sourceType->isIntegerTy(1) ? "bool" :
-                                 "unknown";
-    std::string targetTypeName = targetType->isIntegerTy() ? "int" :
-                                 targetType->isFloatTy() ? "float" :
-                                 targetType->isIntegerTy(1) ? "bool" :
-                                 "unknown";
-
-    // All examples of narrowing conversions as listed above for erroring
-    if (sourceType->isFloatTy() && targetType->isIntegerTy()) {
-        reportError("implicit conversion from '" + sourceTypeName + "' to '" + 
-                   targetTypeName + "' may lose precision", loc);
-    }
-    std::string errorMessage = "Unsupported type conversion from " + sourceTypeName + 
-                                " to " + targetTypeName;
-    reportError(errorMessage, loc);
-}
-
-void pushScope() {
-    NamedValuesStack.emplace_back();
+std::unique_ptr<llvm::TargetMachine> createTargetMachine(const std::string& triple, std::string& error) {
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target)
+        return nullptr;
+    return std::unique_ptr<llvm::TargetMachine>(
+        target->createTargetMachine(triple, "generic", "", llvm::TargetOptions(), llvm::Reloc::PIC_));
 }
 
-void popScope() {
-    if (!NamedValuesStack.empty()) {
-        NamedValuesStack.pop_back();
-    } else {
-        reportError("Attempted to pop an empty scope", {});
+llvm::Value* convertValue(llvm::Value* val, MiniCType from, MiniCType to) {
+    if (from == to)
+        return val;
+
+    switch (to) {
+        case MiniCType::Int:
+            // Widening bool to int: true becomes 1 and false becomes 0
+            return Builder.CreateZExt(val, getLLVMType(to), "bool_to_int");
+        case MiniCType::Float:
+            if (from == MiniCType::Bool)
+                val = Builder.CreateZExt(val, getLLVMType(MiniCType::Int), "bool_to_int");
+            return Builder.CreateSIToFP(val, getLLVMType(to), "int_to_float");
+        case MiniCType::Bool:
+            // Non-zero is true
+            if (from == MiniCType::Float)
+                return Builder.CreateFCmpONE(val, llvm::ConstantFP::get(val->getType(), 0.0), "float_to_bool");
+            return Builder.CreateICmpNE(val, llvm::ConstantInt::get(val->getType(), 0), "int_to_bool");
+        default:
+            llvm_unreachable("sema allows no other conversion");
     }
 }
-
-VariableInfo* findVariable(const std::string& name) {
-    // Search from innermost scope to outermost
-    for (auto scopeIt = NamedValuesStack.rbegin(); scopeIt != NamedValuesStack.rend(); ++scopeIt) {
-        auto varIt = scopeIt->find(name);
-        if (varIt != scopeIt->end()) {
-            return &varIt->second;
-        }
-    }
-    // Check global variables
-    auto globalVarIt = GlobalNamedValues.find(name);
-    if (globalVarIt != GlobalNamedValues.end()) {
-        return &globalVarIt->second;
-    }
-    return nullptr;
-}
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <queue>
 #include <string.h>
 #include <string>
@@ -13,34 +14,21 @@
 #include <utility>
 #include <vector>
 #include "llvm_context.h"
-#include "lexer.h"
-#include "tokens.h"
-#include "parser.h"
 #include "ast.h"
+#include "compiler.h"
+#include "optimizer.h"
+#include "output.h"
 
 using namespace llvm;
 using namespace llvm::sys;
 
-//===----------------------------------------------------------------------===//
-// Code Generation
-//===----------------------------------------------------------------------===//
-
-llvm::LLVMContext TheContext;
-llvm::IRBuilder<> Builder(TheContext);
-std::unique_ptr<llvm::Module> TheModule;
-
-std::map<std::string, VariableInfo> NamedValues;
-std::map<std::string, VariableInfo> GlobalNamedValues;
-extern std::string currentFilename;
-
-
 //===----------------------------------------------------------------------===//
 // AST Printer
 //===----------------------------------------------------------------------===//
 
 inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
                                      const ASTnode &ast) {
-  os << ast.to_string();
+  dumpAST(&ast, os);
   return os;
 }
 
@@ -49,58 +37,126 @@ inline llvm::raw_ostream &operator<<(llvm::raw_ostream &os,
 //===----------------------------------------------------------------------===//
 
 int main(int argc, char **argv) {
-    if (argc == 2) {
-        currentFilename = argv[1];
-        pFile = fopen(argv[1], "r");
-        if (pFile == NULL) {
-            perror("Error opening file");
-            return 1;
+    // --prelex lexes the whole file before parsing instead of one token at a time.
+    // An InputFile of "-" reads standard input; "-o -" writes the IR to standard output.
+    // --parser=ll1 parses with the table-driven parser instead of recursive descent.
+    // -j N parses top-level declarations on N threads; it implies --prelex and
+    // applies to the recursive-descent parser only.
+    // --flat-ast flattens the AST (flat_ast.h) and generates code from that copy.
+    // --emit-ast=File also saves the flattened AST to File (ast_file.h), and
+    // --load-ast=File generates code from a saved AST without lexing or parsing
+    // (so without an AST dump), provided it was saved for the current text of
+    // InputFile; otherwise the input is parsed as usual.
+    // --ast-dump=tree|json prints the parsed AST to stdout, or to stderr when the
+    // IR goes to stdout; --ast-dump=none, the default, prints nothing.
+    // --check-only stops after semantic analysis: the exit status says whether
+    // the program is valid, and no module is created or written.
+    // -O0, -O1, -O2, -O3 and -Os optimize the module before it is written
+    // (optimizer.h); -O0, the default, writes it as generated.
+    // The module is written as LLVM IR text by default or with --emit-llvm, as
+    // bitcode with --emit-bc, as assembly with -S, or as an object with -c.
+    // --link=Object, which may be repeated, links it with Object into an
+    // executable instead (output.h). Without -o the file is named output.ll,
+    // output.bc, output.s, output.o or output to match. --module-summary adds
+    // the module summary index that ThinLTO reads to the bitcode of --emit-bc.
+    // Everything up to the module is compileModule() (compiler.h), which other
+    // tools can call to get the module without writing it out.
+    CompileOptions options;
+    std::optional<OutputKind> outputKind;
+    std::vector<std::string> linkInputs;
+    bool moduleSummary = false;
+    const char *inputFile = nullptr;
+    const char *outputFile = nullptr;
+    int numInputs = 0;
+    bool badArgs = false;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--prelex")) {
+            options.prelex = true;
+        } else if (!strcmp(argv[i], "--parser=ll1")) {
+            options.ll1 = true;
+        } else if (!strcmp(argv[i], "--parser=rd")) {
+            options.ll1 = false;
+        } else if (!strcmp(argv[i], "--check-only")) {
+            options.checkOnly = true;
+        } else if (!strcmp(argv[i], "--flat-ast")) {
+            options.flatAST = true;
+        } else if (!strncmp(argv[i], "--emit-ast=", 11)) {
+            options.emitASTFile = argv[i] + 11;
+        } else if (!strncmp(argv[i], "--load-ast=", 11)) {
+            options.loadASTFile = argv[i] + 11;
+        } else if (!strcmp(argv[i], "--ast-dump=tree")) {
+            options.dumpFormat = ASTDumpFormat::Tree;
+        } else if (!strcmp(argv[i], "--ast-dump=json")) {
+            options.dumpFormat = ASTDumpFormat::JSON;
+        } else if (!strcmp(argv[i], "--ast-dump=none")) {
+            options.dumpFormat = ASTDumpFormat::None;
+        } else if (!strncmp(argv[i], "--ast-dump", 10)) {
+            badArgs = true;
+        } else if (!strncmp(argv[i], "-O", 2)) {
+            if (std::optional<OptLevel> level = parseOptLevel(argv[i] + 2))
+                options.optLevel = *level;
+            else
+                badArgs = true;
+        } else if (!strcmp(argv[i], "--emit-llvm")) {
+            outputKind = OutputKind::LLVMIR;
+        } else if (!strcmp(argv[i], "--emit-bc")) {
+            outputKind = OutputKind::Bitcode;
+        } else if (!strcmp(argv[i], "--module-summary")) {
+            moduleSummary = true;
+        } else if (!strcmp(argv[i], "-S")) {
+            outputKind = OutputKind::Assembly;
+        } else if (!strcmp(argv[i], "-c")) {
+            outputKind = OutputKind::Object;
+        } else if (!strncmp(argv[i], "--link=", 7)) {
+            linkInputs.push_back(argv[i] + 7);
+        } else if (!strcmp(argv[i], "-j")) {
+            if (i + 1 < argc && atoi(argv[i + 1]) > 0)
+                options.jobs = atoi(argv[++i]);
+            else
+                badArgs = true;
+        } else if (!strcmp(argv[i], "-o")) {
+            if (i + 1 < argc)
+                outputFile = argv[++i];
+            else
+                badArgs = true;
+        } else {
+            inputFile = argv[i];
+            ++numInputs;
         }
-    } else {
-        std::cout << "Usage: ./mccomp InputFile\n";
-        return 1;
     }
-
-    // initialize line number and column numbers
-    lineNo = 1;
-    columnNo = 1;
-    std::string filename = argv[1];  // save the filename for the error msg
-
-    // get the first token
-    getNextToken();
-
-    // Make the module, which holds all the code
-    TheModule = std::make_unique<Module>("mini-c", TheContext);
-    
-    //Set the target triple
-    TheModule->setTargetTriple(llvm::sys::getDefaultTargetTriple());
-
-    // Run the parser and get the AST
-    auto ast = parser();
-    if (!ast) {
-        llvm::errs() << "Failed to generate AST\n";
+    // Linking decides the output itself, so it takes no other output option
+    if (!linkInputs.empty()) {
+        badArgs |= outputKind.has_value();
+        outputKind = OutputKind::Executable;
+    }
+    if (!outputKind)
+        outputKind = OutputKind::LLVMIR;
+    if (!outputFile)
+        outputFile = getDefaultOutputFile(*outputKind);
+    bool outputToStdout = !strcmp(outputFile, "-");
+    badArgs |= outputToStdout && outputKind == OutputKind::Executable;
+    badArgs |= moduleSummary && outputKind != OutputKind::Bitcode;
+    if (badArgs || numInputs != 1) {
+        std::cout << "Usage: ./mccomp [--prelex] [--parser=rd|ll1] [--ast-dump=tree|json|none] [--check-only] [-O0|-O1|-O2|-O3|-Os] [--emit-llvm|--emit-bc [--module-summary]|-S|-c|--link=Object...] [--flat-ast] [--emit-ast=File] [--load-ast=File] [-j Jobs] [-o OutputFile] InputFile\n";
         return 1;
     }
 
-    // Generate code from the AST
-    Value* result = ast->codegen();
-    if (!result) {
-        // If codegen failed, don't proceed to output
+    // Kept off stdout when the IR goes there, so it can be piped straight into the next tool
+    options.dumpStream = outputToStdout ? &errs() : &outs();
+    std::string error;
+    std::unique_ptr<Module> module = compileModule(inputFile, options, error);
+    if (!module) {
+        if (error.empty())
+            return options.checkOnly ? 0 : 1;
+        errs() << error << "\n";
         return 1;
     }
 
-    //********************* Start printing final IR **************************
-    // Print out all of the generated code into a file called output.ll
-    auto outputFile = "output.ll";
-    std::error_code EC;
-    raw_fd_ostream dest(outputFile, EC, sys::fs::OF_None);
-
-    if (EC) {
-        errs() << "Could not open file: " << EC.message();
+    // Write out the module, as IR or machine code or linked into a program
+    std::string outputError;
+    if (!writeOutput(*module, *outputKind, outputFile, moduleSummary, linkInputs, outputError)) {
+        errs() << "Could not write " << outputFile << ": " << outputError << "\n";
         return 1;
     }
-
-    TheModule->print(dest, nullptr);
-    fclose(pFile);
     return 0;
-}
\ No newline at end of file
+}
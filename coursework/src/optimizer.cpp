@@ -0,0 +1,62 @@
+#include "optimizer.h"
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include "llvm_context.h"
+#include "llvm/Passes/OptimizationLevel.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "llvm/Target/TargetMachine.h"
+
+std::optional<OptLevel> parseOptLevel(const char* name) {
+    static const char* const names[] = {"0", "1", "2", "3", "s"};
+    for (size_t i = 0; i < std::size(names); ++i) {
+        if (!strcmp(name, names[i]))
+            return OptLevel(i);
+    }
+    return std::nullopt;
+}
+
+static const llvm::OptimizationLevel& getPipelineLevel(OptLevel level) {
+    switch (level) {
+        case OptLevel::O0: return llvm::OptimizationLevel::O0;
+        case OptLevel::O1: return llvm::OptimizationLevel::O1;
+        case OptLevel::O2: return llvm::OptimizationLevel::O2;
+        case OptLevel::O3: return llvm::OptimizationLevel::O3;
+        case OptLevel::Os: return llvm::OptimizationLevel::Os;
+    }
+    llvm_unreachable("unknown OptLevel");
+}
+
+bool optimizeModule(llvm::Module& module, OptLevel level, std::string& error) {
+    if (level == OptLevel::O0)
+        return true;
+
+    // The cost models of the inliner and the vectorizers ask the target
+    std::unique_ptr<llvm::TargetMachine> machine = createTargetMachine(module.getTargetTriple(), error);
+    if (!machine)
+        return false;
+    module.setDataLayout(machine->createDataLayout());
+
+    // clang unrolls and vectorizes loops from -O2, -Os included, but not at -O1
+    llvm::PipelineTuningOptions tuning;
+    bool loopTransforms = level != OptLevel::O1;
+    tuning.LoopUnrolling = loopTransforms;
+    tuning.LoopInterleaving = loopTransforms;
+    tuning.LoopVectorization = loopTransforms;
+    tuning.SLPVectorization = loopTransforms;
+
+    llvm::LoopAnalysisManager LAM;
+    llvm::FunctionAnalysisManager FAM;
+    llvm::CGSCCAnalysisManager CGAM;
+    llvm::ModuleAnalysisManager MAM;
+    llvm::PassBuilder PB(machine.get(), tuning);
+    PB.registerModuleAnalyses(MAM);
+    PB.registerCGSCCAnalyses(CGAM);
+    PB.registerFunctionAnalyses(FAM);
+    PB.registerLoopAnalyses(LAM);
+    PB.crossRegisterProxies(LAM, FAM, CGAM, MAM);
+
+    llvm::ModulePassManager MPM = PB.buildPerModuleDefaultPipeline(getPipelineLevel(level));
+    MPM.run(module, MAM);
+    return true;
+}
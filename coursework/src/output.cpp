@@ -0,0 +1,92 @@
+#include "output.h"
+#include <memory>
+#include "linker.h"
+#include "llvm_context.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FileUtilities.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+const char* getDefaultOutputFile(OutputKind kind) {
+    static const char* const names[] = {"output.ll", "output.bc", "output.s", "output.o", "output"};
+    return names[size_t(kind)];
+}
+
+void writeBitcode(const llvm::Module& module, llvm::raw_ostream& os, bool withSummary) {
+    if (!withSummary) {
+        llvm::WriteBitcodeToFile(module, os);
+        return;
+    }
+    // No profile data, so no block frequencies: every call edge gets the default hotness
+    llvm::ProfileSummaryInfo profile(module);
+    llvm::ModuleSummaryIndex index = llvm::buildModuleSummaryIndex(module, nullptr, &profile);
+    llvm::WriteBitcodeToFile(module, os, false, &index);
+}
+
+// Runs the code generator of the module's target over it, writing assembly or an object to os
+static bool emitMachineCode(llvm::Module& module, llvm::CodeGenFileType fileType, llvm::raw_pwrite_stream& os,
+                            std::string& error) {
+    std::unique_ptr<llvm::TargetMachine> machine = createTargetMachine(module.getTargetTriple(), error);
+    if (!machine)
+        return false;
+    module.setDataLayout(machine->createDataLayout());
+
+    llvm::legacy::PassManager PM;
+    if (machine->addPassesToEmitFile(PM, os, nullptr, fileType)) {
+        error = "the target cannot emit this kind of file";
+        return false;
+    }
+    PM.run(module);
+    return true;
+}
+
+bool writeOutput(llvm::Module& module, OutputKind kind, const std::string& path, bool moduleSummary,
+                 const std::vector<std::string>& linkInputs, std::string& error) {
+    std::error_code EC;
+    if (kind == OutputKind::Executable) {
+        llvm::SmallString<128> object;
+        EC = llvm::sys::fs::createTemporaryFile("mccomp", "o", object);
+        if (EC) {
+            error = "could not create a temporary file: " + EC.message();
+            return false;
+        }
+        llvm::FileRemover removeObject(object);
+        {
+            llvm::raw_fd_ostream os(object, EC, llvm::sys::fs::OF_None);
+            if (EC) {
+                error = "could not open " + std::string(object) + ": " + EC.message();
+                return false;
+            }
+            if (!emitMachineCode(module, llvm::CodeGenFileType::ObjectFile, os, error))
+                return false;
+        }
+        std::vector<std::string> inputs = {std::string(object)};
+        inputs.insert(inputs.end(), linkInputs.begin(), linkInputs.end());
+        return linkExecutable(module.getTargetTriple(), inputs, path, error);
+    }
+
+    llvm::raw_fd_ostream os(path, EC, llvm::sys::fs::OF_None);
+    if (EC) {
+        error = "could not open file: " + EC.message();
+        return false;
+    }
+    switch (kind) {
+        case OutputKind::LLVMIR:
+            module.print(os, nullptr);
+            return true;
+        case OutputKind::Bitcode:
+            writeBitcode(module, os, moduleSummary);
+            return true;
+        case OutputKind::Assembly:
+            return emitMachineCode(module, llvm::CodeGenFileType::AssemblyFile, os, error);
+        case OutputKind::Object:
+            return emitMachineCode(module, llvm::CodeGenFileType::ObjectFile, os, error);
+        default:
+            llvm_unreachable("executables are linked above");
+    }
+}
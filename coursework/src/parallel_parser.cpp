@@ -0,0 +1,178 @@
+#include "parallel_parser.h"
+#include "parser.h"
+#include "error_handler.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include "llvm/ADT/SmallVector.h"
+
+// Chunks per thread. More chunks than threads evens out functions of very
+// different sizes; each chunk still covers many declarations.
+static constexpr unsigned ChunksPerJob = 4;
+
+bool splitTopLevelDecls(const TokenStream& tokens, DeclSplit& split) {
+    const std::vector<int16_t>& types = tokens.types;
+    split = DeclSplit();
+    bool seenDecl = false;
+    size_t i = 0;
+    while (types[i] != EOF_TOK) {
+        if (types[i] == EXTERN) {
+            if (seenDecl)
+                return false;
+            ++split.externs;
+        } else if (FIRST_decl.contains(types[i])) {
+            seenDecl = true;
+        } else {
+            return false;
+        }
+        split.starts.push_back(i);
+
+        // A declaration ends at a ';' or a closing '}' outside any brackets
+        int parens = 0, braces = 0;
+        for (++i;; ++i) {
+            int type = types[i];
+            if (type == EOF_TOK)
+                return false;
+            if (type == LPAR) {
+                ++parens;
+            } else if (type == RPAR) {
+                if (--parens < 0)
+                    return false;
+            } else if (type == LBRA) {
+                ++braces;
+            } else if (type == RBRA) {
+                if (--braces < 0)
+                    return false;
+                if (braces == 0 && parens == 0)
+                    break;
+            } else if (type == SC && braces == 0 && parens == 0) {
+                break;
+            }
+        }
+        ++i;
+    }
+    split.starts.push_back(i);
+    return seenDecl;
+}
+
+// Progress shared by the worker threads of one parallel parse
+static std::mutex ProgressMutex;
+static std::condition_variable ProgressChanged;
+static std::vector<char> ChunkDone;
+static size_t ChunksDonePrefix = 0; // every chunk below this index has parsed
+static thread_local size_t CurrentChunk = 0;
+
+static void markChunkDone(size_t chunk) {
+    std::lock_guard<std::mutex> lock(ProgressMutex);
+    ChunkDone[chunk] = 1;
+    while (ChunksDonePrefix < ChunkDone.size() && ChunkDone[ChunksDonePrefix])
+        ++ChunksDonePrefix;
+    ProgressChanged.notify_all();
+}
+
+// BeforeReportError hook for workers. Chunks are claimed in order, so every earlier
+// chunk is being parsed by a running thread, which either finishes it or reports an
+// earlier error and exits first.
+static void waitForEarlierChunks() {
+    std::unique_lock<std::mutex> lock(ProgressMutex);
+    ProgressChanged.wait(lock, [] { return ChunksDonePrefix >= CurrentChunk; });
+}
+
+struct Chunk {
+    size_t firstDecl; // index into DeclSplit::starts
+    size_t endDecl;
+    std::vector<ASTnode*> decls;
+    bool matched = true; // every declaration ended where the pre-pass said it would
+};
+
+static void parseChunk(const TokenStream& tokens, const DeclSplit& split, Chunk& chunk) {
+    usePrelexedTokens(&tokens, split.starts[chunk.firstDecl]);
+    getNextToken();
+    for (size_t d = chunk.firstDecl; d < chunk.endDecl; ++d) {
+        chunk.decls.push_back(parseDecl());
+        if (prelexedTokenIndex() != split.starts[d + 1]) {
+            chunk.matched = false;
+            return;
+        }
+    }
+}
+
+static ProgramNode* parseProgramSerial(const TokenStream& tokens) {
+    usePrelexedTokens(&tokens);
+    getNextToken();
+    return parseProgram();
+}
+
+ProgramNode* parseProgramParallel(const TokenStream& tokens, unsigned jobs) {
+    DeclSplit split;
+    if (jobs <= 1 || !splitTopLevelDecls(tokens, split))
+        return parseProgramSerial(tokens);
+
+    // Externs are short and come first; parse them here
+    usePrelexedTokens(&tokens);
+    getNextToken();
+    TOKEN loc = CurTok;
+    llvm::SmallVector<ASTnode*, 8> externs;
+    for (size_t d = 0; d < split.externs; ++d) {
+        externs.push_back(parseExtern());
+        if (prelexedTokenIndex() != split.starts[d + 1])
+            return parseProgramSerial(tokens);
+    }
+
+    // Cut the remaining declarations into chunks of about equal token counts
+    size_t numDecls = split.starts.size() - 1;
+    size_t firstToken = split.starts[split.externs];
+    size_t target = (split.starts[numDecls] - firstToken) / (size_t(jobs) * ChunksPerJob) + 1;
+    std::vector<Chunk> chunks;
+    for (size_t d = split.externs; d < numDecls;) {
+        size_t end = d + 1;
+        while (end < numDecls && split.starts[end] - split.starts[d] < target)
+            ++end;
+        chunks.push_back({d, end, {}});
+        d = end;
+    }
+
+    ChunkDone.assign(chunks.size(), 0);
+    ChunksDonePrefix = 0;
+    std::atomic<size_t> nextChunk{0};
+    ASTArena* callerArena = CurrentArena;
+    auto worker = [&] {
+        // Each thread builds its nodes in its own arena, freed with the caller's
+        ASTArena* savedArena = CurrentArena;
+        CurrentArena = &callerArena->createChild();
+        BeforeReportError = waitForEarlierChunks;
+        for (size_t c; (c = nextChunk++) < chunks.size();) {
+            CurrentChunk = c;
+            parseChunk(tokens, split, chunks[c]);
+            markChunkDone(c);
+        }
+        BeforeReportError = nullptr;
+        CurrentArena = savedArena;
+    };
+
+    std::vector<std::thread> threads;
+    unsigned numThreads = std::min<size_t>(jobs, chunks.size());
+    for (unsigned t = 1; t < numThreads; ++t)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread& thread : threads)
+        thread.join();
+
+    std::vector<ASTnode*> declarations;
+    declarations.reserve(numDecls - split.externs);
+    for (Chunk& chunk : chunks) {
+        // A parse that disagrees with the pre-pass is not expected, but the serial
+        // parser is always right
+        if (!chunk.matched)
+            return parseProgramSerial(tokens);
+        declarations.insert(declarations.end(), chunk.decls.begin(), chunk.decls.end());
+    }
+
+    // Leave the main thread's parser where a serial parse would have finished
+    usePrelexedTokens(&tokens, split.starts[numDecls]);
+    getNextToken();
+    return newNode<ProgramNode>(arenaArray<ASTnode*>(externs), arenaArray<ASTnode*>(declarations), loc);
+}
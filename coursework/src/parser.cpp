@@ -1,18 +1,40 @@
 #include "parser.h"
 #include "tokens.h"
 #include "lexer.h"
+#include "token_stream.h"
+#include "operators.h"
 #include "error_handler.h"
-#include <iostream>
 #include <deque>
-#include <unordered_set>
 #include <string>
-#include <memory>
+#include "llvm/ADT/SmallVector.h"
 
-TOKEN CurTok;
-std::deque<TOKEN> tok_buffer;
+thread_local TOKEN CurTok;
+thread_local std::deque<TOKEN> tok_buffer;
+
+// When set, tokens come from a pre-lexed stream walked by index instead of the lexer
+static thread_local const TokenStream *Prelexed = nullptr;
+static thread_local size_t NextTokIndex = 0;
+
+void usePrelexedTokens(const TokenStream *stream, size_t start) {
+    Prelexed = stream;
+    NextTokIndex = start;
+    tok_buffer.clear();
+}
+
+size_t prelexedTokenIndex() {
+    // NextTokIndex stops advancing at the final EOF_TOK, which CurTok then repeats
+    return CurTok.type == EOF_TOK ? Prelexed->size() - 1 : NextTokIndex - 1;
+}
 
 // Keep the token management functions the same
 TOKEN getNextToken() {
+    if (Prelexed) {
+        CurTok = Prelexed->get(NextTokIndex);
+        if (NextTokIndex + 1 < Prelexed->size())
+            ++NextTokIndex;
+        return CurTok;
+    }
+
     if (tok_buffer.empty())
         tok_buffer.push_back(gettok());
 
@@ -22,14 +44,6 @@ TOKEN getNextToken() {
     CurTok = temp;
     return CurTok;
 }
-std::unordered_set<int> FIRST_program = {EXTERN, INT_TOK, FLOAT_TOK, BOOL_TOK, VOID_TOK};
-std::unordered_set<int> FIRST_decl = {INT_TOK, FLOAT_TOK, BOOL_TOK, VOID_TOK};
-std::unordered_set<int> FIRST_type_spec = {INT_TOK, FLOAT_TOK, BOOL_TOK, VOID_TOK};
-std::unordered_set<int> FIRST_expr = {IDENT, INT_LIT, FLOAT_LIT, BOOL_LIT, LPAR, NOT, MINUS};
-std::unordered_set<int> FOLLOW_stmt_list = {RBRA};
-std::unordered_set<int> FOLLOW_param_list = {RPAR};
-std::unordered_set<int> FOLLOW_arg_list = {RPAR};
-std::unordered_set<int> FOLLOW_local_decls = {IDENT, INT_LIT, FLOAT_LIT, BOOL_LIT, IF, WHILE, RETURN, LBRA, RBRA, SC, NOT, MINUS, LPAR};
 
 /**
  * @brief Looks ahead to the next token without consuming it.
@@ -41,6 +55,9 @@ std::unordered_set<int> FOLLOW_local_decls = {IDENT, INT_LIT, FLOAT_LIT, BOOL_LI
  * @return The next TOKEN in the input stream.
  */
 TOKEN peekNextToken() {
+    if (Prelexed)
+        return Prelexed->get(NextTokIndex);
+
     if (tok_buffer.empty()) {
         tok_buffer.push_back(gettok());
     }
@@ -50,108 +67,85 @@ TOKEN peekNextToken() {
 
 //program ::= extern_list decl_list 
 //          | decl_list
-std::unique_ptr<ProgramNode> parseProgram() {
+ProgramNode* parseProgram() {
     TOKEN loc = CurTok;
-    if (!FIRST_program.count(CurTok.type)) {
+    if (!FIRST_program.contains(CurTok.type)) {
         reportError("undefined reference to 'main'", CurTok);
     }
 
-    std::vector<std::unique_ptr<ASTnode>> externs;
-    std::vector<std::unique_ptr<ASTnode>> declarations;
+    llvm::ArrayRef<ASTnode*> externs;
+    llvm::ArrayRef<ASTnode*> declarations;
 
     if (CurTok.type == EXTERN) {
         auto externList = parseExternList();
 
-        externs = std::move(externList->externs);
+        externs = externList->getExterns();
     }
 
     auto declList = parseDeclList();
-    declarations = std::move(declList->declarations);
+    declarations = declList->getDeclarations();
 
     if (CurTok.type != EOF_TOK) {
-        reportError("Expected end of file, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected end of file, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }   
-    return std::make_unique<ProgramNode>(std::move(externs), std::move(declarations), loc);
+    return newNode<ProgramNode>(externs, declarations, loc);
 }
 
 // extern_list ::= extern extern_list'
-std::unique_ptr<ExternListNode> parseExternList() {
+// extern_list' ::= extern extern_list'
+//                | epsilon
+// The right-recursive tail is parsed as a loop, so the stack stays flat however
+// long the list is. The other *_list' productions below are handled the same way.
+ExternListNode* parseExternList() {
     TOKEN loc = CurTok;
     
     if (CurTok.type != EXTERN) {
         reportError("Expected 'extern' keyword at start of extern list", CurTok);
     }
     
-    std::vector<std::unique_ptr<ASTnode>> externs;
-    auto firstExtern = parseExtern();
-    
-    externs.push_back(std::move(firstExtern));
-    
-    return parseExternListPrime(std::move(externs), loc);
-}
-
-// extern_list' ::= extern extern_list'
-//                | epsilon
-std::unique_ptr<ExternListNode> parseExternListPrime(std::vector<std::unique_ptr<ASTnode>>&& externs, TOKEN loc) {
-    
-    if (CurTok.type == EXTERN) {
-        auto nextExtern = parseExtern();
-        externs.push_back(std::move(nextExtern));
-        return parseExternListPrime(std::move(externs), loc);
-    }
+    llvm::SmallVector<ASTnode*, 8> externs;
+    do {
+        externs.push_back(parseExtern());
+    } while (CurTok.type == EXTERN);
     
-    // epsilon production
-    return std::make_unique<ExternListNode>(std::move(externs), loc);
+    return newNode<ExternListNode>(arenaArray<ASTnode*>(externs), loc);
 }
 
 // decl_list ::= decl decl_list'
-std::unique_ptr<DeclListNode> parseDeclList() {
-    TOKEN loc = CurTok;  
-    
-    std::vector<std::unique_ptr<ASTnode>> declarations;
-
-    auto firstDecl = parseDecl();
-    declarations.push_back(std::move(firstDecl));
-    
-    return parseDeclListPrime(std::move(declarations), loc);
-}
-
 // decl_list' ::= decl decl_list'
 //              | epsilon
-std::unique_ptr<DeclListNode> parseDeclListPrime(std::vector<std::unique_ptr<ASTnode>> declarations, TOKEN loc) {
+DeclListNode* parseDeclList() {
+    TOKEN loc = CurTok;  
     
-    if (FIRST_decl.count(CurTok.type)) {
-        auto nextDecl = parseDecl();
-        declarations.push_back(std::move(nextDecl));
-        return parseDeclListPrime(std::move(declarations), loc);
-    }
+    std::vector<ASTnode*> declarations;
+    do {
+        declarations.push_back(parseDecl());
+    } while (FIRST_decl.contains(CurTok.type));
     
-    // epsilon production
-    return std::make_unique<DeclListNode>(std::move(declarations), loc);
+    return newNode<DeclListNode>(arenaArray<ASTnode*>(declarations), loc);
 }
 
 //extern ::= "extern" type_spec IDENT "(" params ")" ";"
-std::unique_ptr<ExternNode> parseExtern() {
+ExternNode* parseExtern() {
     TOKEN loc = CurTok;
     
     if (CurTok.type != EXTERN) {
-        reportError("Expected 'extern' keyword, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected 'extern' keyword, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
-    std::string returnType = parseTypeSpec();
-    if (returnType.empty()) return nullptr;
+    MiniCType returnType = parseTypeSpec();
     
     if (CurTok.type != IDENT) {
         reportError("Expected identifier after return type in extern declaration, got '" + 
-                   CurTok.lexeme + "'", CurTok);
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
-    std::string name = CurTok.lexeme;
+    Symbol name = CurTok.symbol;
     getNextToken();
     
     if (CurTok.type != LPAR) {
         reportError("Expected '(' after function name in extern declaration, got '" + 
-                   CurTok.lexeme + "'", CurTok);
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
@@ -159,37 +153,37 @@ std::unique_ptr<ExternNode> parseExtern() {
     
     if (CurTok.type != RPAR) {
         reportError("Expected ')' after parameters in extern declaration, got '" + 
-                   CurTok.lexeme + "'", CurTok);
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
     if (CurTok.type != SC) {
         reportError("Expected ';' after extern declaration, got '" + 
-                   CurTok.lexeme + "'", CurTok);
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
-    return std::make_unique<ExternNode>(returnType, name, std::move(*params), loc);
+    return newNode<ExternNode>(returnType, name, *params, loc);
 }
 
 
 // var_decl ::= var_type IDENT ";"
-std::unique_ptr<ASTnode> parseVarDecl(const std::string& type, const std::string& name, const TOKEN& loc) {
+ASTnode* parseVarDecl(MiniCType type, Symbol name, const TOKEN& loc) {
     if (CurTok.type != SC) {
         reportError("Expected ';' after variable declaration", CurTok);
     }
     getNextToken();
-    return std::make_unique<VarDeclNode>(type, name, loc);
+    return newNode<VarDeclNode>(type, name, loc);
 }
 
 // fun_decl ::= type_spec IDENT "(" params ")" block
-std::unique_ptr<ASTnode> parseFunDecl(const std::string& returnType, const std::string& name, const TOKEN& loc) {
+ASTnode* parseFunDecl(MiniCType returnType, Symbol name, const TOKEN& loc) {
     // Already past the '('
     getNextToken();
     auto params = parseParams();
     if (CurTok.type != RPAR) {
         reportError("Expected ')' after function parameters, got '" + 
-                CurTok.lexeme + "'", CurTok);
+                std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
 
@@ -198,35 +192,26 @@ std::unique_ptr<ASTnode> parseFunDecl(const std::string& returnType, const std::
         if (CurTok.type == LBRA) {
             reportError("Unexpected extra block after function definition", CurTok);
         }
-        return std::make_unique<FunctionNode>(returnType, name, 
-                                            std::move(*params), 
-                                            std::move(body), 
-                                            loc);
+        return newNode<FunctionNode>(returnType, name, *params, body, loc);
     } else if (CurTok.type == SC) {
         getNextToken();
-        return std::make_unique<FunctionNode>(returnType, name, 
-                                            std::move(*params), 
-                                            nullptr, 
-                                            loc);
+        return newNode<FunctionNode>(returnType, name, *params, nullptr, loc);
     }
     reportError("Expected '{' or ';' after function declaration, got '" + 
-               CurTok.lexeme + "'", CurTok);
+               std::string(CurTok.lexeme) + "'", CurTok);
 }
 
 // decl ::= var_decl
 //        | fun_decl
-std::unique_ptr<ASTnode> parseDecl() {
-    std::string returnType = parseTypeSpec();
-    if (returnType.empty()) {
-        reportError("Expected type specifier at start of declaration", CurTok);
-    }
+ASTnode* parseDecl() {
+    MiniCType returnType = parseTypeSpec();
 
     if (CurTok.type != IDENT) {
         reportError("Expected identifier after return type in declaration", CurTok);
     }
     
     TOKEN loc = CurTok;
-    std::string name = CurTok.lexeme;
+    Symbol name = CurTok.symbol;
     getNextToken();
 
     if (CurTok.type == LPAR) {
@@ -237,10 +222,10 @@ std::unique_ptr<ASTnode> parseDecl() {
 }
 
 // block ::= "{" local_decls stmt_list "}"
-std::unique_ptr<BlockNode> parseBlock() {
+BlockNode* parseBlock() {
     TOKEN loc = CurTok;
     if (CurTok.type != LBRA) {
-        reportError("Expected '{' at start of block", CurTok), " instead got '" + CurTok.lexeme + "'";
+        reportError("Expected '{' at start of block", CurTok), " instead got '" + std::string(CurTok.lexeme) + "'";
     }
     getNextToken();
     
@@ -251,39 +236,23 @@ std::unique_ptr<BlockNode> parseBlock() {
     auto statements = parseStmtList();
     
     if (CurTok.type != RBRA) {
-        reportError("Expected '}' at end of block", CurTok), " instead got '" + CurTok.lexeme + "'";
+        reportError("Expected '}' at end of block", CurTok), " instead got '" + std::string(CurTok.lexeme) + "'";
     }
     getNextToken();
     
-    return std::make_unique<BlockNode>(std::move(declarations->declarations), std::move(statements), loc);
+    return newNode<BlockNode>(declarations, statements, loc);
 }
 
 // local_decls ::= local_decls local_decl
 //               | epsilon
-std::unique_ptr<DeclListNode> parseLocalDecls() {
+llvm::ArrayRef<ASTnode*> parseLocalDecls() {
+    llvm::SmallVector<ASTnode*, 8> decls;
     
-    if (FOLLOW_local_decls.count(CurTok.type)) {
-        return std::make_unique<DeclListNode>(std::vector<std::unique_ptr<ASTnode>>());
+    while (!FOLLOW_local_decls.contains(CurTok.type)) {
+        decls.push_back(parseLocalDecl());
     }
     
-    std::vector<std::unique_ptr<ASTnode>> decls;
-    auto firstDecl = parseLocalDecl();
-    decls.push_back(std::move(firstDecl));
-    
-    return parseLocalDeclsPrime(std::move(decls));
-}
-
-// local_decls' ::= local_decl local_decls' | epsilon
-std::unique_ptr<DeclListNode> parseLocalDeclsPrime(std::vector<std::unique_ptr<ASTnode>>&& decls) {
-    
-    //Check for epsilon production
-    if (FOLLOW_local_decls.count(CurTok.type)) {
-        return std::make_unique<DeclListNode>(std::move(decls));
-    }
-    
-    auto nextDecl = parseLocalDecl();
-    decls.push_back(std::move(nextDecl));
-    return parseLocalDeclsPrime(std::move(decls));
+    return arenaArray<ASTnode*>(decls);
 }
 
 // stmt ::= expr_stmt
@@ -291,7 +260,7 @@ std::unique_ptr<DeclListNode> parseLocalDeclsPrime(std::vector<std::unique_ptr<A
 //        | if_stmt
 //        | while_stmt
 //        | return_stmt
-std::unique_ptr<ASTnode> parseStmt() {
+ASTnode* parseStmt() {
     switch (CurTok.type) {
         case IF:
             return parseIfStmt();
@@ -303,46 +272,30 @@ std::unique_ptr<ASTnode> parseStmt() {
             return parseBlock();
         case SC:
             getNextToken();
-            return std::make_unique<ExprStmtNode>(nullptr);// made to handle empty statements
+            return newNode<ExprStmtNode>(nullptr);// made to handle empty statements
         default:
-            if (FIRST_expr.count(CurTok.type))
+            if (FIRST_expr.contains(CurTok.type))
                 return parseExprStmt();
-                reportError("Unexpected token " + CurTok.lexeme + " in statement", CurTok);
+            reportError("Unexpected token " + std::string(CurTok.lexeme) + " in statement", CurTok);
     }
 }
 
 // stmt_list ::= stmt_list stmt
 //             | epsilon
-std::vector<std::unique_ptr<ASTnode>> parseStmtList() {
+llvm::ArrayRef<ASTnode*> parseStmtList() {
+    llvm::SmallVector<ASTnode*, 8> stmts;
     
-    //Check for epsilon production
-    if (FOLLOW_stmt_list.count(CurTok.type)) {
-        return std::vector<std::unique_ptr<ASTnode>>();
+    while (!FOLLOW_stmt_list.contains(CurTok.type)) {
+        auto stmt = parseStmt();
+        if (!stmt) return {};
+        stmts.push_back(stmt);
     }
     
-    std::vector<std::unique_ptr<ASTnode>> stmts;
-    auto firstStmt = parseStmt();
-    if (!firstStmt) return std::vector<std::unique_ptr<ASTnode>>();
-    stmts.push_back(std::move(firstStmt));
-    
-    return parseStmtListPrime(std::move(stmts));
-}
-
-//stmt_list' ::= stmt stmt_list' | epsilon
-std::vector<std::unique_ptr<ASTnode>> parseStmtListPrime(std::vector<std::unique_ptr<ASTnode>>&& stmts) {
-    
-    if (CurTok.type != RBRA) {
-        auto nextStmt = parseStmt();
-        if (!nextStmt) return std::vector<std::unique_ptr<ASTnode>>();
-        stmts.push_back(std::move(nextStmt));
-        return parseStmtListPrime(std::move(stmts));
-    }
-
-    return stmts;
+    return arenaArray<ASTnode*>(stmts);
 }
 
 // if_stmt ::= "if" "(" expr ")" block else_stmt
-std::unique_ptr<IfNode> parseIfStmt() {
+IfNode* parseIfStmt() {
     TOKEN loc = CurTok;
     getNextToken();
     
@@ -354,38 +307,38 @@ std::unique_ptr<IfNode> parseIfStmt() {
     auto condition = parseExpr();
     
     if (CurTok.type != RPAR) {
-        reportError("Expected ')' after if condition, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected ')' after if condition, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
     auto thenBlock = parseBlock();
     
-    std::unique_ptr<ASTnode> elseBlock = nullptr;
+    ASTnode* elseBlock = nullptr;
     if (CurTok.type == ELSE) {
         getNextToken();
         elseBlock = parseBlock();
     }
     
-    return std::make_unique<IfNode>(std::move(condition), std::move(thenBlock), std::move(elseBlock), loc);
+    return newNode<IfNode>(condition, thenBlock, elseBlock, loc);
 }
 
 // expr_stmt ::= expr ";"
 //             | ";"
-std::unique_ptr<ASTnode> parseExprStmt() {
+ASTnode* parseExprStmt() {
     TOKEN loc = CurTok;
     auto expr = parseExpr();
     
     if (CurTok.type != SC) {
-        reportError("Expected ';' after expression statement, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected ';' after expression statement, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
-    return std::make_unique<ExprStmtNode>(std::move(expr), loc);
+    return newNode<ExprStmtNode>(expr, loc);
 }
 
 // return_stmt ::= "return" ";"
 //               | "return" expr ";"
-std::unique_ptr<ReturnNode> parseReturnStmt() {
+ReturnNode* parseReturnStmt() {
     
     TOKEN loc = CurTok;
 
@@ -393,393 +346,304 @@ std::unique_ptr<ReturnNode> parseReturnStmt() {
     
     if (CurTok.type == SC) {
         getNextToken();
-        return std::make_unique<ReturnNode>(nullptr, loc); // In the case of a void return
+        return newNode<ReturnNode>(nullptr, loc); // In the case of a void return
     }
     
     auto expr = parseExpr();
     
     if (CurTok.type != SC) {
-        reportError("Expected semicolon after return statement, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected semicolon after return statement, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
-    return std::make_unique<ReturnNode>(std::move(expr), loc);
-}
-
-// relation ::= additive relation'
-std::unique_ptr<ASTnode> parseRelational() {
-    auto left = parseAdditive();
-    return parseRelationalPrime(std::move(left));
-}
-
-// relation' ::= ("<=" | "<" | ">=" | ">") additive relation'
-//             | epsilon
-std::unique_ptr<ASTnode> parseRelationalPrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == LT || CurTok.type == GT || 
-        CurTok.type == LE || CurTok.type == GE) {
-        std::string op;
-        TOKEN loc = CurTok;;
-        switch (CurTok.type) {
-            case LT: op = "<"; break;
-            case GT: op = ">"; break;
-            case LE: op = "<="; break;
-            case GE: op = ">="; break;
-        }
-        getNextToken();
-        auto right = parseAdditive();
-        auto newLeft = std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right), loc);
-        return parseRelationalPrime(std::move(newLeft));
-    }
-    return left;
-}
-
-// equality ::= relation equality'
-std::unique_ptr<ASTnode> parseEquality() {
-    auto left = parseRelational();
-    return parseEqualityPrime(std::move(left));
-}
-
-// equality' ::= ("==" | "!=") relation equality'
-//             | epsilon
-std::unique_ptr<ASTnode> parseEqualityPrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == EQ || CurTok.type == NE) {
-        TOKEN loc = CurTok;;
-        std::string op = CurTok.type == EQ ? "==" : "!=";
-        getNextToken();
-        auto right = parseRelational();
-        auto newLeft = std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right), loc);
-        return parseEqualityPrime(std::move(newLeft));
-    }
-    return left;
-}
-
-// logic_and ::= equality logic_and'
-std::unique_ptr<ASTnode> parseLogicAnd() {
-    auto left = parseEquality();
-    return parseLogicAndPrime(std::move(left));
-}
-
-// logic_and' ::= "&&" equality logic_and'
-//              | epsilon
-std::unique_ptr<ASTnode> parseLogicAndPrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == AND) {
-        TOKEN loc = CurTok;;
-        getNextToken();
-        auto right = parseEquality();
-        auto newLeft = std::make_unique<BinaryOpNode>("&&", std::move(left), std::move(right), loc);
-        return parseLogicAndPrime(std::move(newLeft));
-    }
-    return left;
-}
-
-// logic_or ::= logic_and logic_or'
-std::unique_ptr<ASTnode> parseLogicOr() {
-    auto left = parseLogicAnd();
-    return parseLogicOrPrime(std::move(left));
-}
-
-// logic_or' ::= "||" logic_and logic_or'
-//             | epsilon
-std::unique_ptr<ASTnode> parseLogicOrPrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == OR) {
-        TOKEN loc = CurTok;;
-        getNextToken();
-        auto right = parseLogicAnd();
-        auto newLeft = std::make_unique<BinaryOpNode>("||", std::move(left), std::move(right), loc);
-        return parseLogicOrPrime(std::move(newLeft));
+    return newNode<ReturnNode>(expr, loc);
+}
+
+// An operator, parenthesis or call whose operands are still being parsed
+struct PendingExpr {
+    // Kinds up to Binary are reduced when their assign_expr ends
+    enum Kind : uint8_t { Assign, Unary, Binary, Group, Call };
+    Kind kind;
+    uint8_t op;         // the UnaryOp or BinaryOp
+    uint8_t precedence; // of a Binary
+    uint32_t firstArg;  // of a Call, in the operand stack
+    TOKEN loc;
+};
+
+// Builds the node for the pending assignment or operator on top of pending from
+// the operands it has taken
+static void reduce(llvm::SmallVectorImpl<PendingExpr>& pending, llvm::SmallVectorImpl<ASTnode*>& operands) {
+    const PendingExpr& top = pending.back();
+    ASTnode* right = operands.pop_back_val();
+    switch (top.kind) {
+        case PendingExpr::Assign:
+            operands.push_back(newNode<AssignNode>(top.loc.symbol, right, top.loc));
+            break;
+        case PendingExpr::Unary:
+            operands.push_back(newNode<UnaryOpNode>(UnaryOp(top.op), right, top.loc));
+            break;
+        case PendingExpr::Binary:
+            operands.back() = newNode<BinaryOpNode>(BinaryOp(top.op), operands.back(), right, top.loc);
+            break;
+        default:
+            llvm_unreachable("parentheses and calls are closed by their ')'");
     }
-    return left;
+    pending.pop_back();
 }
 
 // expr ::= assign_expr
-std::unique_ptr<ASTnode> parseExpr() {
-    return parseAssignExpr();
-}
-
-// assign_expr ::= IDENT "=" assign_expr  
+//
+// assign_expr ::= IDENT "=" assign_expr
 //               | logic_or
-std::unique_ptr<ASTnode> parseAssignExpr() {
-    if (CurTok.type == IDENT) {
-        TOKEN loc = CurTok;
-        TOKEN idTok = CurTok;
-        TOKEN nextTok = peekNextToken();
-        
-        if (nextTok.type == ASSIGN) {
-            getNextToken();
-            getNextToken();
-            auto rhs = parseAssignExpr();
-            return std::make_unique<AssignNode>(idTok.lexeme, std::move(rhs), loc);
-        }
-    }
-    return parseLogicOr();
-}
-
-// additive ::= multiply additive'
-std::unique_ptr<ASTnode> parseAdditive() {
-    auto left = parseMultiply();
-
-    return parseAdditivePrime(std::move(left));
-}
-
-// additive' ::= ("+" | "-") multiply additive'
-//             | epsilon
-std::unique_ptr<ASTnode> parseAdditivePrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == PLUS || CurTok.type == MINUS) {
-        std::string op = CurTok.type == PLUS ? "+" : "-";
-        TOKEN loc = CurTok;;
-        getNextToken();
-        auto right = parseMultiply();
-        auto newLeft = std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right), loc);
-        return parseAdditivePrime(std::move(newLeft));
-    }
-    return left;
-}
-
-// multiply ::= unary multiply'
-std::unique_ptr<ASTnode> parseMultiply() {
-    auto left = parseUnary();
-    return parseMultiplyPrime(std::move(left));
-}
-
-// multiply' ::= ("*" | "/" | "%") unary multiply'
-//             | epsilon
-std::unique_ptr<ASTnode> parseMultiplyPrime(std::unique_ptr<ASTnode> left) {
-    if (CurTok.type == ASTERIX || CurTok.type == DIV || CurTok.type == MOD) {
-        std::string op;
-        switch (CurTok.type) {
-            case ASTERIX: op = "*"; break;
-            case DIV: op = "/"; break;
-            case MOD: op = "%"; break;
-        }
-        TOKEN loc = CurTok;;
-        getNextToken();
-        auto right = parseUnary();
-        auto newLeft = std::make_unique<BinaryOpNode>(op, std::move(left), std::move(right), loc);
-        return parseMultiplyPrime(std::move(newLeft));
-    }
-    return left;
-}
-
+//
+// logic_or ::= logic_and ("||" logic_and)*
+// logic_and ::= equality ("&&" equality)*
+// equality ::= relation (("==" | "!=") relation)*
+// relation ::= additive (("<=" | "<" | ">=" | ">") additive)*
+// additive ::= multiply (("+" | "-") multiply)*
+// multiply ::= unary (("*" | "/" | "%") unary)*
+//
+// unary ::= ("-" | "!") unary
+//         | primary
+//
 // primary ::= "(" expr ")"
 //           | IDENT
 //           | IDENT "(" args ")"
 //           | INT_LIT
 //           | FLOAT_LIT
 //           | BOOL_LIT
-std::unique_ptr<ASTnode> parsePrimary() {
-    switch (CurTok.type) {
-        case IDENT: {
-            std::string name = CurTok.lexeme;
-            TOKEN loc = CurTok;;
-
+//
+// args ::= arg_list
+//        | epsilon
+// arg_list ::= expr ("," expr)*
+//
+// Generated code nests expressions tens of thousands deep, so they are parsed
+// with explicit stacks rather than one call per level: operands holds the
+// finished subexpressions and pending the assignments, operators, parentheses
+// and calls still waiting for theirs. Binary operators are ordered by
+// precedence climbing over BinaryOperators (operators.h): an operator first
+// reduces the pending ones that bind at least as tightly, so equal precedence
+// associates to the left, and a prefix operator binds tighter than any binary
+// one. An assignment is right associative and reduced last, at the end of its
+// assign_expr, which is also where a "(" or call waits for its ")" or ",".
+ASTnode* parseExpr() {
+    llvm::SmallVector<ASTnode*, 16> operands;
+    llvm::SmallVector<PendingExpr, 16> pending;
+    bool atAssignExpr = true;
+
+    for (;;) {
+        // Operand position: prefixes until a primary completes an operand
+        if (atAssignExpr && CurTok.type == IDENT && peekNextToken().type == ASSIGN) {
+            pending.push_back({PendingExpr::Assign, 0, 0, 0, CurTok});
             getNextToken();
-            if (CurTok.type == LPAR) {
+            getNextToken();
+            continue;
+        }
+        atAssignExpr = false;
+
+        switch (CurTok.type) {
+            case MINUS:
+            case NOT: {
+                UnaryOp op = (CurTok.type == MINUS) ? UnaryOp::Neg : UnaryOp::Not;
+                pending.push_back({PendingExpr::Unary, uint8_t(op), 0, 0, CurTok});
                 getNextToken();
-                auto args = parseArgList();
+                continue;
+            }
+            case LPAR:
+                pending.push_back({PendingExpr::Group, 0, 0, 0, CurTok});
+                getNextToken();
+                atAssignExpr = true;
+                continue;
+            case IDENT: {
+                TOKEN loc = CurTok;
+                getNextToken();
+                if (CurTok.type != LPAR) {
+                    operands.push_back(newNode<VariableNode>(loc.symbol, loc));
+                    break;
+                }
+                getNextToken();
+                if (!FOLLOW_arg_list.contains(CurTok.type)) {
+                    pending.push_back({PendingExpr::Call, 0, 0, uint32_t(operands.size()), loc});
+                    atAssignExpr = true;
+                    continue;
+                }
                 if (CurTok.type != RPAR) {
                     reportError("Expected ')' after function arguments", CurTok);
                 }
                 getNextToken();
-                return std::make_unique<FunctionCallNode>(name, std::move(*args), loc);
+                operands.push_back(newNode<FunctionCallNode>(loc.symbol, llvm::ArrayRef<ASTnode*>(), loc));
+                break;
             }
-            return std::make_unique<VariableNode>(name, loc);
-        }
-        case INT_LIT: {
-            int val = std::stoi(CurTok.lexeme);
-            TOKEN loc = CurTok;;
-            getNextToken();
-            return std::make_unique<LiteralNode>(val, loc);
-        }
-        case FLOAT_LIT: {
-            float val = std::stof(CurTok.lexeme);
-            TOKEN loc = CurTok;;
-            getNextToken();
-            return std::make_unique<LiteralNode>(val, loc);
-        }
-        case BOOL_LIT: {
-            bool val = (CurTok.lexeme == "true");
-            TOKEN loc = CurTok;;
-            getNextToken();
-            return std::make_unique<LiteralNode>(val, loc);
+            case INT_LIT:
+                operands.push_back(newNode<LiteralNode>(CurTok.intVal, CurTok));
+                getNextToken();
+                break;
+            case FLOAT_LIT:
+                operands.push_back(newNode<LiteralNode>(CurTok.floatVal, CurTok));
+                getNextToken();
+                break;
+            case BOOL_LIT:
+                operands.push_back(newNode<LiteralNode>(CurTok.boolVal, CurTok));
+                getNextToken();
+                break;
+            default:
+                reportError("Unexpected token " + std::string(CurTok.lexeme) + " in primary expression", CurTok);
         }
-        case LPAR: {
-            getNextToken();
-            auto expr = parseExpr();
 
+        // Operator position: a binary operator continues the expression, and
+        // anything else ends the innermost assign_expr
+        for (;;) {
+            const BinaryOperatorInfo& info = binaryOperatorInfo(CurTok.type);
+            if (info.precedence) {
+                while (!pending.empty() && (pending.back().kind == PendingExpr::Unary ||
+                                            (pending.back().kind == PendingExpr::Binary &&
+                                             pending.back().precedence >= info.precedence)))
+                    reduce(pending, operands);
+                pending.push_back({PendingExpr::Binary, uint8_t(info.op), info.precedence, 0, CurTok});
+                getNextToken();
+                break;
+            }
+
+            while (!pending.empty() && pending.back().kind <= PendingExpr::Binary)
+                reduce(pending, operands);
+            if (pending.empty())
+                return operands.back();
+
+            PendingExpr& open = pending.back();
+            if (open.kind == PendingExpr::Group) {
+                if (CurTok.type != RPAR) {
+                    reportError("Expected ')' after expression in primary expression", CurTok);
+                }
+                getNextToken();
+                pending.pop_back();
+                continue;
+            }
+            if (CurTok.type == COMMA) {
+                getNextToken();
+                atAssignExpr = true;
+                break;
+            }
             if (CurTok.type != RPAR) {
-                reportError("Expected ')' after expression in primary expression", CurTok);
+                reportError("Expected ')' after function arguments", CurTok);
             }
             getNextToken();
-            return expr;
+            auto args = arenaArray(llvm::ArrayRef<ASTnode*>(operands).drop_front(open.firstArg));
+            operands.resize(open.firstArg);
+            operands.push_back(newNode<FunctionCallNode>(open.loc.symbol, args, open.loc));
+            pending.pop_back();
         }
-        default:
-            reportError("Unexpected token " + CurTok.lexeme + " in primary expression", CurTok);
-    }
-}
-
-// unary ::= ("-" | "!") unary
-//         | primary
-std::unique_ptr<ASTnode> parseUnary() {
-    if (CurTok.type == MINUS || CurTok.type == NOT) {
-        std::string op = (CurTok.type == MINUS) ? "-" : "!";
-        TOKEN loc = CurTok;;
-        getNextToken();
-        
-        auto operand = parseUnary();     
-        return std::make_unique<UnaryOpNode>(op, std::move(operand), loc);
     }
-    
-    return parsePrimary();
 }
 
 // local_decl ::= var_type IDENT ";"
-std::unique_ptr<ASTnode> parseLocalDecl() {
-    std::string type = parseTypeSpec();
+ASTnode* parseLocalDecl() {
+    MiniCType type = parseTypeSpec();
     
     if (CurTok.type != IDENT) {
-        reportError("Expected identifier after type '" + type + "', got '" + 
-                   CurTok.lexeme + "'", CurTok);
+        reportError("Expected identifier after type '" + std::string(typeName(type)) + "', got '" + 
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     TOKEN loc = CurTok;
-    std::string name = CurTok.lexeme;
+    Symbol name = CurTok.symbol;
     getNextToken();
     
     if (CurTok.type != SC) {
         reportError("Expected semicolon after variable declaration, got '" + 
-                   CurTok.lexeme + "'", CurTok);
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
-    return std::make_unique<VarDeclNode>(type, name, loc);
+    return newNode<VarDeclNode>(type, name, loc);
 }
 
 // type_spec ::= "void"
 //             | var_type
-std::string parseTypeSpec() {
-    std::string type = CurTok.lexeme;
-    
-    if (!FIRST_type_spec.count(CurTok.type)) {
+MiniCType parseTypeSpec() {
+    if (!FIRST_type_spec.contains(CurTok.type)) {
         reportError("Expected type specifier (int, float, bool, void), got '" + 
-                   CurTok.lexeme + "'", CurTok);
-       
-        return "";
+                   std::string(CurTok.lexeme) + "'", CurTok);
     }
     
+    MiniCType type = typeFromToken(CurTok.type);
     getNextToken();
     return type;
 }
 
 // while_stmt ::= "while" "(" expr ")" stmt
-std::unique_ptr<WhileNode> parseWhile() {
+WhileNode* parseWhile() {
     TOKEN loc = CurTok;
     getNextToken();
     
     if (CurTok.type != LPAR) {
-        reportError("Expected '(' after while, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected '(' after while, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
     auto condition = parseExpr();
     
     if (CurTok.type != RPAR) {
-        reportError("Expected ')' after while condition, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected ')' after while condition, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     getNextToken();
     
     auto body = parseStmt();
     
-    return std::make_unique<WhileNode>(std::move(condition), std::move(body), loc);
+    return newNode<WhileNode>(condition, body, loc);
 }
 
 // params ::= param_list
 //          | "void"
 //          | epsilon
-std::optional<std::vector<std::pair<std::string, std::string>>> parseParams() {
+std::optional<llvm::ArrayRef<Param>> parseParams() {
     
-    if (FOLLOW_param_list.count(CurTok.type)) {
-        return std::vector<std::pair<std::string, std::string>>();
+    if (FOLLOW_param_list.contains(CurTok.type)) {
+        return llvm::ArrayRef<Param>();
     }
     
     if (CurTok.type == VOID_TOK) {
         getNextToken();
-        return std::vector<std::pair<std::string, std::string>>();
+        return llvm::ArrayRef<Param>();
     }
     
     return parseParamList();
 }
 
 // param ::= var_type IDENT
-std::optional<std::pair<std::string, std::string>> parseParam() {
+std::optional<Param> parseParam() {
     
-    if (!FIRST_type_spec.count(CurTok.type)) {
-        reportError("Expected type specifier in parameter, got '" + CurTok.lexeme + "'", CurTok);
+    if (!FIRST_type_spec.contains(CurTok.type)) {
+        reportError("Expected type specifier in parameter, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
     
-    std::string type = parseTypeSpec();
-    if (type.empty()) return std::nullopt;
+    MiniCType type = parseTypeSpec();
     
     if (CurTok.type != IDENT) {
-        reportError("Expected identifier in parameter, got '" + CurTok.lexeme + "'", CurTok);
+        reportError("Expected identifier in parameter, got '" + std::string(CurTok.lexeme) + "'", CurTok);
     }
-    std::string name = CurTok.lexeme;
+    Symbol name = CurTok.symbol;
     getNextToken();
     
-    return std::make_pair(type, name);
+    return Param(type, name);
 }
 
 // param_list ::= param param_list'
-std::optional<std::vector<std::pair<std::string, std::string>>> parseParamList() {
-    std::vector<std::pair<std::string, std::string>> params;
-    
-    auto firstParam = parseParam();
-
-    params.push_back(std::move(*firstParam));
-    return parseParamListPrime(std::move(params));
-}
-
 // param_list' ::= "," param param_list'
 //               | epsilon
-std::optional<std::vector<std::pair<std::string, std::string>>> parseParamListPrime(
-    std::vector<std::pair<std::string, std::string>>&& params) {
+std::optional<llvm::ArrayRef<Param>> parseParamList() {
+    llvm::SmallVector<Param, 8> params;
     
-    if (CurTok.type == COMMA) {
+    params.push_back(*parseParam());
+    while (CurTok.type == COMMA) {
         getNextToken();
-        auto nextParam = parseParam();
-        params.push_back(std::move(*nextParam));
-        return parseParamListPrime(std::move(params));
+        params.push_back(*parseParam());
     }
     
-    // epsilon production
-    return params;
-}
-std::optional<std::vector<std::unique_ptr<ASTnode>>> parseArgList() {
-
-    if (FOLLOW_arg_list.count(CurTok.type)) {
-        return std::vector<std::unique_ptr<ASTnode>>();
-    }
-    
-    std::vector<std::unique_ptr<ASTnode>> args;
-    auto firstArg = parseExpr();
-    args.push_back(std::move(firstArg));
-    
-    return parseArgListPrime(std::move(args));
-}
-
-std::optional<std::vector<std::unique_ptr<ASTnode>>> parseArgListPrime(
-    std::vector<std::unique_ptr<ASTnode>>&& args) { 
-    if (CurTok.type == COMMA) {
-        getNextToken();
-        auto nextArg = parseExpr();
-        args.push_back(std::move(nextArg));
-        return parseArgListPrime(std::move(args));
-    }
-    return args;
+    return arenaArray<Param>(params);
 }
 
-std::unique_ptr<ASTnode> parser() {
+ASTnode* parser() {
     auto program = parseProgram();
     if (program) {
-        std::cout << program->to_string();
         return program;
     } else {
         reportError("Parsing failed", CurTok);
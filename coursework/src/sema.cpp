@@ -0,0 +1,422 @@
+#include "sema.h"
+#include "error_handler.h"
+#include <algorithm>
+
+void sema(ASTnode* node) {
+    Sema().visit(node);
+}
+
+void sema(const FlatAST& ast) {
+    ast.sema.assign(ast.nodes.size(), FlatNodeSema{0, MiniCType::Void});
+    FlatSema().visit(FlatPtr<ASTnode>(&ast, 0));
+}
+
+// How conversion diagnostics name a type: bool shares int's name, as both are LLVM integers
+static std::string conversionTypeName(MiniCType type) {
+    switch (type) {
+        case MiniCType::Int:
+        case MiniCType::Bool:
+            return "int";
+        case MiniCType::Float:
+            return "float";
+        default:
+            return "unknown";
+    }
+}
+
+template <template <typename> class Ptr>
+void SemaBase<Ptr>::checkConversion(MiniCType from, MiniCType to, bool inConditionalContext, const TOKEN& loc) {
+    if (from == to)
+        return;
+
+    // Widening conversions are always allowed
+    if (from == MiniCType::Bool && (to == MiniCType::Int || to == MiniCType::Float))
+        return;
+    if (from == MiniCType::Int && to == MiniCType::Float)
+        return;
+
+    // Anything numeric tests as a bool in a condition, and nowhere else
+    if (to == MiniCType::Bool) {
+        if (inConditionalContext) {
+            if (from == MiniCType::Int || from == MiniCType::Float)
+                return;
+        } else {
+            Note note{"narrowing conversions are not allowed in return statements and function calls", loc};
+            reportError("Cannot convert from '" + conversionTypeName(from) +
+                            "' to 'bool' outside conditional context",
+                        loc, true, &note);
+        }
+    }
+
+    if (from == MiniCType::Float && (to == MiniCType::Int || to == MiniCType::Bool)) {
+        reportError("implicit conversion from 'float' to '" + conversionTypeName(to) + "' may lose precision", loc);
+    }
+    reportError("Unsupported type conversion from " + conversionTypeName(from) + " to " + conversionTypeName(to),
+                loc);
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitProgramNode(Ptr<ProgramNode> node) {
+    for (const auto& ext : node->getExterns())
+        visit(ext);
+    for (const auto& decl : node->getDeclarations())
+        visit(decl);
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitExternListNode(Ptr<ExternListNode> node) {
+    for (const auto& ext : node->getExterns())
+        visit(ext);
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitDeclListNode(Ptr<DeclListNode> node) {
+    for (const auto& decl : node->getDeclarations())
+        visit(decl);
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitExternNode(Ptr<ExternNode> node) {
+    // The first declaration of a name is the one calls resolve to
+    uint32_t index = NumFunctions++;
+    Functions.try_emplace(node->getName(), Function{index, node->getType(), node->getParams(), node->getLoc(), false});
+    node->setFunctionIndex(index);
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitVarDeclNode(Ptr<VarDeclNode> node) {
+    Symbol name = node->getName();
+    TOKEN loc = node->getLoc();
+
+    bool global = Variables.depth() == 0;
+    if (const Variable* previous = Variables.lookupInCurrentScope(name)) {
+        Note note{"previous declaration of '" + symbolName(name) + "' was here", previous->declLocation};
+        reportError(std::string("Redefinition of ") + (global ? "global" : "local") + " variable '" +
+                        symbolName(name) + "'",
+                    loc, true, &note);
+    }
+    uint32_t slot = global ? GlobalSlotBit | NumGlobals++ : NumLocals++;
+    Variables.declare(name, {node->getType(), slot, loc});
+    node->setSlot(slot);
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitFunctionNode(Ptr<FunctionNode> node) {
+    Symbol name = node->getName();
+    llvm::ArrayRef<Param> params = node->getParams();
+    TOKEN loc = node->getLoc();
+
+    // A definition may follow an extern or prototype of the same type (mutual recursion)
+    uint32_t index;
+    auto existing = Functions.find(name);
+    if (existing != Functions.end()) {
+        const Function& previous = existing->second;
+        bool sameType = previous.returnType == node->getReturnType() && previous.params.size() == params.size();
+        for (size_t i = 0; sameType && i < params.size(); ++i)
+            sameType = previous.params[i].first == params[i].first;
+        if (!sameType) {
+            Note note{"previous declaration is here", previous.declLocation};
+            reportError("conflicting types for '" + symbolName(name) + "'", loc, true, &note);
+        }
+        if (previous.defined && node->getBody()) {
+            Note note{"previous definition is here", previous.declLocation};
+            reportError("redefinition of '" + symbolName(name) + "'", loc, true, &note);
+        }
+        index = previous.index;
+    } else {
+        index = NumFunctions++;
+    }
+    // Notes about the function point at its definition from here on; a
+    // prototype only declares it, and may come before or after the definition
+    if (node->getBody() || existing == Functions.end())
+        Functions[name] = {index, node->getReturnType(), params, loc, bool(node->getBody())};
+    node->setFunctionIndex(index);
+
+    FunctionName = name;
+    ReturnType = node->getReturnType();
+    NumLocals = 0;
+    Variables.pushScope();
+    for (const Param& param : params) {
+        if (const Variable* previous = Variables.lookupInCurrentScope(param.second)) {
+            Note note{"previous declaration of parameter '" + symbolName(param.second) + "' was here",
+                      previous->declLocation};
+            reportError("Duplicate parameter name '" + symbolName(param.second) + "'", loc, true, &note);
+        }
+        Variables.declare(param.second, {param.first, NumLocals++, loc});
+    }
+
+    if (node->getBody())
+        visit(node->getBody());
+    Returned = false;
+    Variables.popScope();
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitBlockNode(Ptr<BlockNode> node) {
+    Variables.pushScope();
+    for (const auto& decl : node->getDeclarations())
+        visit(decl);
+
+    Returned = false;
+    for (const auto& stmt : node->getStatements()) {
+        visit(stmt);
+        // Codegen stops at a return, so what follows it is never checked either
+        if (Returned)
+            break;
+    }
+    Variables.popScope();
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitIfNode(Ptr<IfNode> node) {
+    TOKEN loc = node->getLoc();
+
+    checkConversion(visit(node->getCondition()), MiniCType::Bool, true, loc);
+    visit(node->getThen());
+    if (node->getElse()) {
+        Returned = false;
+        visit(node->getElse());
+    }
+    // Code after the if is reached through its merge block
+    Returned = false;
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitWhileNode(Ptr<WhileNode> node) {
+    TOKEN loc = node->getLoc();
+
+    checkConversion(visit(node->getCondition()), MiniCType::Bool, true, loc);
+    visit(node->getBody());
+    Returned = false;
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitReturnNode(Ptr<ReturnNode> node) {
+    Ptr<ASTnode> value = node->getValue();
+    TOKEN loc = node->getLoc();
+
+    if (ReturnType == MiniCType::Void && value) {
+        reportError("void function '" + symbolName(FunctionName) + "' cannot return a value", loc);
+    }
+    if (ReturnType != MiniCType::Void && !value) {
+        reportError("non-void function '" + symbolName(FunctionName) + "' should return a value", loc);
+    }
+    if (value)
+        checkConversion(visit(value), ReturnType, false, loc);
+
+    Returned = true;
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitExprStmtNode(Ptr<ExprStmtNode> node) {
+    if (node->getExpr())
+        visit(node->getExpr());
+    return MiniCType::Void;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitBinaryOpNode(Ptr<BinaryOpNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitUnaryOpNode(Ptr<UnaryOpNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitAssignNode(Ptr<AssignNode> node) {
+    return this->walkExpression(node);
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitFunctionCallNode(Ptr<FunctionCallNode> node) {
+    return this->walkExpression(node);
+}
+
+// A call is resolved, and its argument count checked, before any argument
+template <template <typename> class Ptr>
+void SemaBase<Ptr>::enterExpression(Ptr<ASTnode> node) {
+    if (node->getKind() != ASTnode::Kind::FunctionCall)
+        return;
+    auto call = static_cast<Ptr<FunctionCallNode>>(node);
+    Symbol name = call->getName();
+    auto arguments = call->getArguments();
+    TOKEN loc = call->getLoc();
+    auto CalleeIt = Functions.find(name);
+    if (CalleeIt == Functions.end()) {
+        reportError("Call to undeclared function '" + symbolName(name) + "'", loc);
+    }
+    Function callee = CalleeIt->second;
+
+    // Check argument count
+    size_t expectedArgs = callee.params.size();
+    size_t providedArgs = arguments.size();
+
+    if (expectedArgs != providedArgs) {
+        TOKEN errorLoc = loc;  // Where "foo" starts
+        errorLoc.lexeme = symbolName(name);  // Set lexeme to function name for highlighting
+
+        // Caret at the first extra argument, or just after the last one provided;
+        // each argument is counted as two columns with its comma
+        int caretCol = loc.columnNo() + symbolName(name).length() + 1;  // After "foo("
+        caretCol += 2 * std::min(expectedArgs, providedArgs);
+
+        // Create caret position - just the caret, no highlighting
+        CaretPosition caret{caretCol, false};
+
+        std::string msg;
+        if (providedArgs > expectedArgs) {
+            msg = "too many arguments to function call, expected " +
+                std::to_string(expectedArgs) + ", have " +
+                std::to_string(providedArgs);
+        } else {
+            msg = "too few arguments to function call, expected " +
+                std::to_string(expectedArgs) + ", have " +
+                std::to_string(providedArgs);
+        }
+
+        Note note{
+            "function '" + symbolName(name) + "' declared here",
+            callee.declLocation
+        };
+
+        reportError(msg, errorLoc, true, &note, &caret);
+    }
+
+    call->setCallee(callee.index);
+    call->setExprType(callee.returnType);
+}
+
+// Each operand of "&&" and "||", and each argument, is checked as soon as it is evaluated
+template <template <typename> class Ptr>
+void SemaBase<Ptr>::exitOperand(Ptr<ASTnode> node, unsigned index, Ptr<ASTnode> operand, MiniCType& type) {
+    if (node->getKind() == ASTnode::Kind::BinaryOp) {
+        if (isShortCircuit(static_cast<Ptr<BinaryOpNode>>(node)->getOp()))
+            checkConversion(type, MiniCType::Bool, true, node->getLoc());
+    } else if (node->getKind() == ASTnode::Kind::FunctionCall) {
+        const Function& callee = Functions.find(static_cast<Ptr<FunctionCallNode>>(node)->getName())->second;
+        checkConversion(type, callee.params[index].first, false, operand->getLoc());
+    }
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::exitExpression(Ptr<ASTnode> node, llvm::ArrayRef<MiniCType> operands) {
+    switch (node->getKind()) {
+        case ASTnode::Kind::BinaryOp:
+            return checkBinaryOp(static_cast<Ptr<BinaryOpNode>>(node), operands[0], operands[1]);
+        case ASTnode::Kind::UnaryOp:
+            return checkUnaryOp(static_cast<Ptr<UnaryOpNode>>(node), operands[0]);
+        case ASTnode::Kind::Assign:
+            return checkAssign(static_cast<Ptr<AssignNode>>(node), operands[0]);
+        default:
+            return node->getExprType();
+    }
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::checkBinaryOp(Ptr<BinaryOpNode> node, MiniCType L, MiniCType R) {
+    BinaryOp op = node->getOp();
+    TOKEN loc = node->getLoc();
+    MiniCType result;
+
+    if (isShortCircuit(op)) {
+        result = MiniCType::Bool;
+    } else {
+        // Float if either operand is; otherwise int, except that two bools compare as they are
+        if (L == MiniCType::Float || R == MiniCType::Float) {
+            checkConversion(L, MiniCType::Float, false, loc);
+            checkConversion(R, MiniCType::Float, false, loc);
+            if (op == BinaryOp::Mod)
+                reportError("Modulo not supported for floating point", loc);
+            result = MiniCType::Float;
+        } else {
+            bool bothBool = L == MiniCType::Bool && R == MiniCType::Bool;
+            if (!bothBool || !isComparison(op)) {
+                checkConversion(L, MiniCType::Int, false, loc);
+                checkConversion(R, MiniCType::Int, false, loc);
+            }
+            result = MiniCType::Int;
+        }
+        if (isComparison(op))
+            result = MiniCType::Bool;
+    }
+
+    node->setExprType(result);
+    return result;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::checkUnaryOp(Ptr<UnaryOpNode> node, MiniCType operand) {
+    TOKEN loc = node->getLoc();
+    MiniCType result;
+
+    if (node->getOp() == UnaryOp::Not) {
+        checkConversion(operand, MiniCType::Bool, true, loc);
+        result = MiniCType::Bool;
+    } else if (operand == MiniCType::Float) {
+        result = MiniCType::Float;
+    } else {
+        checkConversion(operand, MiniCType::Int, false, loc);
+        result = MiniCType::Int;
+    }
+
+    node->setExprType(result);
+    return result;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::checkAssign(Ptr<AssignNode> node, MiniCType value) {
+    TOKEN loc = node->getLoc();
+
+    const Variable* var = Variables.lookup(node->getName());
+    if (!var) {
+        reportError("Use of undeclared identifier '" + symbolName(node->getName()) + "'", loc);
+    }
+    // Unlike a return or an argument, an assignment may convert to bool
+    checkConversion(value, var->type, var->type == MiniCType::Bool, loc);
+
+    node->setSlot(var->slot);
+    node->setExprType(var->type);
+    return var->type;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitVariableNode(Ptr<VariableNode> node) {
+    const Variable* var = Variables.lookup(node->getName());
+    if (!var) {
+        reportError("Use of undeclared identifier '" + symbolName(node->getName()) + "'", node->getLoc());
+    }
+
+    node->setSlot(var->slot);
+    node->setExprType(var->type);
+    return var->type;
+}
+
+template <template <typename> class Ptr>
+MiniCType SemaBase<Ptr>::visitLiteralNode(Ptr<LiteralNode> node) {
+    MiniCType type = MiniCType::Void;
+    switch (node->getLiteralType()) {
+        case LiteralNode::LiteralType::Int:
+            type = MiniCType::Int;
+            break;
+        case LiteralNode::LiteralType::Float:
+            type = MiniCType::Float;
+            break;
+        case LiteralNode::LiteralType::Bool:
+            type = MiniCType::Bool;
+            break;
+    }
+    node->setExprType(type);
+    return type;
+}
@@ -0,0 +1,217 @@
+#include "simd_scan.h"
+
+#if defined(__SSE2__)
+#define MCCOMP_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+//===----------------------------------------------------------------------===//
+// Scalar kernels (fallback and tail handling)
+//===----------------------------------------------------------------------===//
+
+static inline bool isWhitespaceByte(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline bool isIdentifierByte(unsigned char c) {
+    return ((c | 0x20) >= 'a' && (c | 0x20) <= 'z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+static const char* skipWhitespaceScalar(const char* p, const char* end) {
+    while (p != end && isWhitespaceByte(*p)) ++p;
+    return p;
+}
+
+static const char* skipIdentifierScalar(const char* p, const char* end) {
+    while (p != end && isIdentifierByte(*p)) ++p;
+    return p;
+}
+
+static const char* skipDigitsScalar(const char* p, const char* end) {
+    while (p != end && *p >= '0' && *p <= '9') ++p;
+    return p;
+}
+
+static const char* findLineEndScalar(const char* p, const char* end) {
+    while (p != end && *p != '\n' && *p != '\r') ++p;
+    return p;
+}
+
+static const ScanKernels ScalarKernels = {
+    skipWhitespaceScalar, skipIdentifierScalar, skipDigitsScalar, findLineEndScalar, "scalar"};
+
+#ifdef MCCOMP_X86_SIMD
+
+//===----------------------------------------------------------------------===//
+// SSE2 kernels (16 bytes per step)
+//===----------------------------------------------------------------------===//
+
+// Byte-wise lo <= x <= hi using a signed compare: shifting lo to -128 leaves
+// exactly the range [-128, -128 + (hi - lo)] below the bound.
+static inline __m128i inRange16(__m128i x, char lo, char hi) {
+    __m128i shifted = _mm_add_epi8(x, _mm_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1)));
+}
+
+static inline __m128i whitespaceMask16(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')), inRange16(x, '\t', '\r'));
+}
+
+static inline __m128i identifierMask16(__m128i x) {
+    __m128i letter = inRange16(_mm_or_si128(x, _mm_set1_epi8(0x20)), 'a', 'z');
+    __m128i digit = inRange16(x, '0', '9');
+    __m128i underscore = _mm_cmpeq_epi8(x, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letter, digit), underscore);
+}
+
+static inline __m128i digitMask16(__m128i x) {
+    return inRange16(x, '0', '9');
+}
+
+static inline __m128i lineEndMask16(__m128i x) {
+    return _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('\n')),
+                        _mm_cmpeq_epi8(x, _mm_set1_epi8('\r')));
+}
+
+// Advances over 16-byte blocks whose bytes all match; stops at the first mismatch
+#define SSE2_SKIP_WHILE(MASK_FN, SCALAR_FN)                                          \
+    while (end - p >= 16) {                                                          \
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));        \
+        unsigned mismatch = ~static_cast<unsigned>(_mm_movemask_epi8(MASK_FN(block))) & 0xFFFF; \
+        if (mismatch) return p + __builtin_ctz(mismatch);                            \
+        p += 16;                                                                     \
+    }                                                                                \
+    return SCALAR_FN(p, end);
+
+static const char* skipWhitespaceSSE2(const char* p, const char* end) {
+    SSE2_SKIP_WHILE(whitespaceMask16, skipWhitespaceScalar)
+}
+
+static const char* skipIdentifierSSE2(const char* p, const char* end) {
+    SSE2_SKIP_WHILE(identifierMask16, skipIdentifierScalar)
+}
+
+static const char* skipDigitsSSE2(const char* p, const char* end) {
+    SSE2_SKIP_WHILE(digitMask16, skipDigitsScalar)
+}
+
+static const char* findLineEndSSE2(const char* p, const char* end) {
+    while (end - p >= 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(lineEndMask16(block)));
+        if (hit) return p + __builtin_ctz(hit);
+        p += 16;
+    }
+    return findLineEndScalar(p, end);
+}
+
+#undef SSE2_SKIP_WHILE
+
+static const ScanKernels SSE2Kernels = {
+    skipWhitespaceSSE2, skipIdentifierSSE2, skipDigitsSSE2, findLineEndSSE2, "sse2"};
+
+//===----------------------------------------------------------------------===//
+// AVX2 kernels (32 bytes per step), compiled for AVX2 without requiring it globally
+//===----------------------------------------------------------------------===//
+
+#define MCCOMP_AVX2 __attribute__((target("avx2")))
+
+MCCOMP_AVX2 static inline __m256i inRange32(__m256i x, char lo, char hi) {
+    __m256i shifted = _mm256_add_epi8(x, _mm256_set1_epi8(static_cast<char>(0x80 - lo)));
+    return _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(-128 + (hi - lo) + 1)), shifted);
+}
+
+MCCOMP_AVX2 static inline __m256i whitespaceMask32(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')), inRange32(x, '\t', '\r'));
+}
+
+MCCOMP_AVX2 static inline __m256i identifierMask32(__m256i x) {
+    __m256i letter = inRange32(_mm256_or_si256(x, _mm256_set1_epi8(0x20)), 'a', 'z');
+    __m256i digit = inRange32(x, '0', '9');
+    __m256i underscore = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('_'));
+    return _mm256_or_si256(_mm256_or_si256(letter, digit), underscore);
+}
+
+MCCOMP_AVX2 static inline __m256i digitMask32(__m256i x) {
+    return inRange32(x, '0', '9');
+}
+
+MCCOMP_AVX2 static inline __m256i lineEndMask32(__m256i x) {
+    return _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n')),
+                           _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\r')));
+}
+
+// Most runs are shorter than 16 bytes, so one SSE2-width probe goes first and the
+// 32-byte loop (with its wider constant setup) only starts on longer runs.
+#define AVX2_SKIP_WHILE(MASK_FN, SSE2_MASK_FN, SSE2_FN)                              \
+    if (end - p >= 16) {                                                             \
+        __m128i probe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));        \
+        unsigned mismatch = ~static_cast<unsigned>(_mm_movemask_epi8(SSE2_MASK_FN(probe))) & 0xFFFF; \
+        if (mismatch) return p + __builtin_ctz(mismatch);                            \
+        p += 16;                                                                     \
+    }                                                                                \
+    while (end - p >= 32) {                                                          \
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));     \
+        unsigned mismatch = ~static_cast<unsigned>(_mm256_movemask_epi8(MASK_FN(block))); \
+        if (mismatch) return p + __builtin_ctz(mismatch);                            \
+        p += 32;                                                                     \
+    }                                                                                \
+    return SSE2_FN(p, end);
+
+MCCOMP_AVX2 static const char* skipWhitespaceAVX2(const char* p, const char* end) {
+    AVX2_SKIP_WHILE(whitespaceMask32, whitespaceMask16, skipWhitespaceSSE2)
+}
+
+MCCOMP_AVX2 static const char* skipIdentifierAVX2(const char* p, const char* end) {
+    AVX2_SKIP_WHILE(identifierMask32, identifierMask16, skipIdentifierSSE2)
+}
+
+MCCOMP_AVX2 static const char* skipDigitsAVX2(const char* p, const char* end) {
+    AVX2_SKIP_WHILE(digitMask32, digitMask16, skipDigitsSSE2)
+}
+
+MCCOMP_AVX2 static const char* findLineEndAVX2(const char* p, const char* end) {
+    if (end - p >= 16) {
+        __m128i probe = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(lineEndMask16(probe)));
+        if (hit) return p + __builtin_ctz(hit);
+        p += 16;
+    }
+    while (end - p >= 32) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(lineEndMask32(block)));
+        if (hit) return p + __builtin_ctz(hit);
+        p += 32;
+    }
+    return findLineEndSSE2(p, end);
+}
+
+#undef AVX2_SKIP_WHILE
+
+static const ScanKernels AVX2Kernels = {
+    skipWhitespaceAVX2, skipIdentifierAVX2, skipDigitsAVX2, findLineEndAVX2, "avx2"};
+
+#endif // MCCOMP_X86_SIMD
+
+ScanISA detectScanISA() {
+#ifdef MCCOMP_X86_SIMD
+    static const ScanISA Detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return ScanISA::AVX2;
+        if (__builtin_cpu_supports("sse2")) return ScanISA::SSE2;
+        return ScanISA::Scalar;
+    }();
+    return Detected;
+#else
+    return ScanISA::Scalar;
+#endif
+}
+
+const ScanKernels& getScanKernels(ScanISA isa) {
+#ifdef MCCOMP_X86_SIMD
+    ScanISA best = detectScanISA();
+    if (isa == ScanISA::AVX2 && best == ScanISA::AVX2) return AVX2Kernels;
+    if (isa != ScanISA::Scalar && best != ScanISA::Scalar) return SSE2Kernels;
+#endif
+    return ScalarKernels;
+}
@@ -0,0 +1,58 @@
+#include "source_buffer.h"
+#include <algorithm>
+
+llvm::SourceMgr SrcMgr;
+
+unsigned loadSourceFile(const std::string& path, std::error_code& EC) {
+    // getSTDIN reads the whole stream into a NUL-terminated buffer named "<stdin>"
+    auto BufferOrErr = path == "-" ? llvm::MemoryBuffer::getSTDIN()
+                                   : llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                                                 /*RequiresNullTerminator=*/true);
+    if (!BufferOrErr) {
+        EC = BufferOrErr.getError();
+        return 0;
+    }
+    return SrcMgr.AddNewSourceBuffer(std::move(*BufferOrErr), llvm::SMLoc());
+}
+
+std::pair<int, int> getLineAndColumn(SourceLoc loc) {
+    if (loc.fileId == 0) return {0, 0};
+    const char* Ptr = SrcMgr.getMemoryBuffer(loc.fileId)->getBufferStart() + loc.offset;
+    // SourceMgr::getLineAndColumn finds the column by scanning back to the start
+    // of the line, which is quadratic over a long line (an expression nested a
+    // million deep); the line table already knows where each line starts.
+    const auto& Buffer = SrcMgr.getBufferInfo(loc.fileId);
+    unsigned LineNo = Buffer.getLineNumber(Ptr);
+    const char* LineStart = Buffer.getPointerForLineNumber(LineNo);
+    return {static_cast<int>(LineNo), static_cast<int>(Ptr - LineStart) + 1};
+}
+
+std::string_view getLineText(SourceLoc loc) {
+    if (loc.fileId == 0) return {};
+    const llvm::MemoryBuffer* Buffer = SrcMgr.getMemoryBuffer(loc.fileId);
+    const char* BufStart = Buffer->getBufferStart();
+    const char* BufEnd = Buffer->getBufferEnd();
+
+    const char* LineStart = BufStart + loc.offset;
+    while (LineStart != BufStart && LineStart[-1] != '\n' && LineStart[-1] != '\r') {
+        --LineStart;
+    }
+    const char* LineEnd = BufStart + loc.offset;
+    while (LineEnd != BufEnd && *LineEnd != '\n' && *LineEnd != '\r') {
+        ++LineEnd;
+    }
+    return std::string_view(LineStart, LineEnd - LineStart);
+}
+
+std::string_view getSourceText(SourceLoc loc, size_t length) {
+    if (loc.fileId == 0) return {};
+    const llvm::MemoryBuffer* Buffer = SrcMgr.getMemoryBuffer(loc.fileId);
+    size_t Available = Buffer->getBufferSize() - loc.offset;
+    return std::string_view(Buffer->getBufferStart() + loc.offset, std::min(length, Available));
+}
+
+std::string_view getFilename(SourceLoc loc) {
+    if (loc.fileId == 0) return {};
+    llvm::StringRef Name = SrcMgr.getMemoryBuffer(loc.fileId)->getBufferIdentifier();
+    return std::string_view(Name.data(), Name.size());
+}
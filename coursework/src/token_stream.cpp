@@ -0,0 +1,50 @@
+#include "token_stream.h"
+#include "lexer.h"
+#include "source_buffer.h"
+#include <cstring>
+
+TokenStream lexAll(unsigned BufferID) {
+    TokenStream stream;
+    const llvm::MemoryBuffer* Buffer = SrcMgr.getMemoryBuffer(BufferID);
+    stream.bufferId = BufferID;
+    stream.bufferStart = Buffer->getBufferStart();
+
+    // Dense code averages under three bytes per token. Reserving generously avoids
+    // regrowth copies, and capacity that is never written is never paged in.
+    size_t estimate = Buffer->getBufferSize() / 2 + 1;
+    stream.types.reserve(estimate);
+    stream.offsets.reserve(estimate);
+    stream.lengths.reserve(estimate);
+    stream.values.reserve(estimate);
+
+    initLexer(BufferID);
+    for (;;) {
+        TOKEN tok = gettok();
+        uint32_t value;
+        std::memcpy(&value, &tok.intVal, sizeof(value));
+
+        stream.types.push_back(static_cast<int16_t>(tok.type));
+        stream.offsets.push_back(tok.srcLoc.offset);
+        stream.lengths.push_back(tok.type == EOF_TOK ? 0 : static_cast<uint32_t>(tok.lexeme.size()));
+        stream.values.push_back(value);
+        if (tok.type == EOF_TOK)
+            break;
+    }
+    return stream;
+}
+
+TOKEN TokenStream::get(size_t i) const {
+    if (i >= size())
+        i = size() - 1;
+
+    SourceLoc loc{bufferId, offsets[i]};
+    TOKEN tok = types[i] == EOF_TOK
+                    ? returnTok("0", EOF_TOK, loc)
+                    : returnTok(std::string_view(bufferStart + offsets[i], lengths[i]), types[i], loc);
+    std::memcpy(&tok.intVal, &values[i], sizeof(values[i]));
+    return tok;
+}
+
+size_t TokenStream::memoryUsage() const {
+    return size() * (sizeof(int16_t) + sizeof(uint32_t) * 3);
+}
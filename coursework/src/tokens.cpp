@@ -1,16 +1,18 @@
 #include "tokens.h"
-#include "lexer.h"
-#include <iostream>
+#include "source_buffer.h"
 
-extern int lineNo, columnNo;
-
-TOKEN returnTok(std::string lexVal, int tok_type) {
+TOKEN returnTok(std::string_view lexVal, int tok_type, SourceLoc loc) {
     TOKEN return_tok;
     return_tok.lexeme = lexVal;
     return_tok.type = tok_type;
-    return_tok.lineNo = lineNo;
-    return_tok.columnNo = columnNo - lexVal.length() - 1;
-    return_tok.lineContent = currentLineContent;
-    return_tok.filename = currentFilename;
+    return_tok.srcLoc = loc;
     return return_tok;
-}
\ No newline at end of file
+}
+
+int TOKEN::lineNo() const {
+    return getLineAndColumn(srcLoc).first;
+}
+
+int TOKEN::columnNo() const {
+    return getLineAndColumn(srcLoc).second;
+}
@@ -0,0 +1,201 @@
+#!/bin/bash
+set -e
+export LLVM_INSTALL_PATH=/modules/cs325/llvm-18.1.8
+export PATH=$LLVM_INSTALL_PATH/bin:$PATH
+export LD_LIBRARY_PATH=$LLVM_INSTALL_PATH/lib:$LD_LIBRARY_PATH
+
+module load GCC/13.3.0
+
+DIR="$(pwd)"
+
+### Build mccomp compiler
+echo "Cleanup *****"
+rm -rf ./mccomp
+
+echo "Compile *****"
+
+make clean
+make -j mccomp
+
+COMP=$DIR/mccomp
+echo $COMP
+
+# Every compile runs with this stack limit (KB), far below what one frame per
+# list element would need at these sizes.
+STACK_KB=1024
+GEN_DIR=$DIR/stress-tests/gen
+
+# One function whose body is a block of $1 assignment statements
+function gen_long_block {
+  awk -v n=$1 'BEGIN {
+    print "int main() {"
+    print "    int x;"
+    print "    x = 0;"
+    for (i = 0; i < n; i++) print "    x = x + 1;"
+    print "    return x;"
+    print "}"
+  }'
+}
+
+# $1 small functions followed by main
+function gen_many_functions {
+  awk -v n=$1 'BEGIN {
+    for (i = 0; i < n; i++) print "int f" i "(int a, int b) { return a + b; }"
+    print "int main() { return f0(1, 2); }"
+  }'
+}
+
+# main returning one expression whose left operands nest $1 deep:
+# ((((x + 1) + 1) + 1) ... + 1)
+function gen_deep_left {
+  awk -v n=$1 'BEGIN {
+    print "int main() {"
+    print "    int x;"
+    print "    x = 1;"
+    printf "    return "
+    for (i = 0; i < n; i++) printf "("
+    printf "x"
+    for (i = 0; i < n; i++) printf " + 1)"
+    print ";"
+    print "}"
+  }'
+}
+
+# main returning one expression whose right operands nest $1 deep:
+# x - (x - (x - ... (x - 1)))
+function gen_deep_right {
+  awk -v n=$1 'BEGIN {
+    print "int main() {"
+    print "    int x;"
+    print "    x = 1;"
+    printf "    return "
+    for (i = 0; i < n; i++) printf "x - ("
+    printf "1"
+    for (i = 0; i < n; i++) printf ")"
+    print ";"
+    print "}"
+  }'
+}
+
+# main returning a chain of $1 unary operators: -!-! ... -!x
+function gen_unary_chain {
+  awk -v n=$1 'BEGIN {
+    print "int main() {"
+    print "    int x;"
+    print "    x = 1;"
+    printf "    return "
+    for (i = 0; i < n; i++) printf (i % 2 ? "!" : "-")
+    print "x;"
+    print "}"
+  }'
+}
+
+# Times one compile under the stack limit, with any further arguments passed to
+# mccomp; prints milliseconds. Diagnostics go to a .err file next to the source
+# and are shown if the compile fails.
+function timed_compile {
+  local src=$1
+  shift
+  local start=$(date +%s%N)
+  if ! ( ulimit -s $STACK_KB; "$COMP" "$@" "$src" -o /dev/null > /dev/null 2> "${src%.c}.err" ); then
+    tail -n 5 "${src%.c}.err" >&2
+    return 1
+  fi
+  echo $(( ($(date +%s%N) - start) / 1000000 ))
+}
+
+# Compiles sizes n/10 and n, with any further arguments passed to mccomp; fails
+# if either compile fails or time grows far faster than the input (10x the input
+# should take roughly 10x as long).
+function run_scaling_test {
+  local name=$1
+  local generator=$2
+  local n=$3
+  shift 3
+
+  mkdir -p $GEN_DIR
+  $generator $(( n / 10 )) > $GEN_DIR/${name}_small.c
+  $generator $n > $GEN_DIR/${name}.c
+
+  echo
+  echo "$name: $(( n / 10 )) and $n elements, stack limit ${STACK_KB}KB${*:+, $*}"
+  local small large
+  small=$(timed_compile $GEN_DIR/${name}_small.c "$@") || { echo "TEST FAILED *****"; return 1; }
+  large=$(timed_compile $GEN_DIR/${name}.c "$@") || { echo "TEST FAILED *****"; return 1; }
+  echo "  small: ${small} ms  large: ${large} ms"
+
+  if (( large > 25 * (small + 10) )); then
+    echo "  time grew more than 25x for a 10x larger input"
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "PASSED"
+  rm -f $GEN_DIR/${name}_small.* $GEN_DIR/${name}.*
+}
+
+# Compiles $1 top-level functions serially and with -j 4; the IR must match
+function run_parallel_test {
+  local n=$1
+
+  mkdir -p $GEN_DIR
+  gen_many_functions $n > $GEN_DIR/parallel.c
+
+  echo
+  echo "parallel_parse: $n functions, serial and -j 4, stack limit ${STACK_KB}KB"
+  if ! ( ulimit -s $STACK_KB; "$COMP" "$GEN_DIR/parallel.c" -o $GEN_DIR/serial.ll > /dev/null 2> $GEN_DIR/parallel.err &&
+         "$COMP" -j 4 "$GEN_DIR/parallel.c" -o $GEN_DIR/parallel.ll > /dev/null 2>> $GEN_DIR/parallel.err ); then
+    tail -n 5 $GEN_DIR/parallel.err
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  if ! cmp -s $GEN_DIR/serial.ll $GEN_DIR/parallel.ll; then
+    echo "  -j 4 produced different IR"
+    echo "TEST FAILED *****"
+    return 1
+  fi
+  echo "PASSED"
+  rm -f $GEN_DIR/parallel.* $GEN_DIR/serial.ll
+}
+
+function list_options {
+  echo "Select a test to run:"
+  echo "1) long_block (1M statements in one block)"
+  echo "2) many_functions (100k top-level functions)"
+  echo "3) parallel_parse (100k functions, serial vs -j 4)"
+  echo "4) deep_left (expression nested 1M deep on the left)"
+  echo "5) deep_right (expression nested 1M deep on the right)"
+  echo "6) unary_chain (1M unary operators)"
+  echo "7) dump_tree (deep_left with --ast-dump=tree)"
+  echo "8) dump_json (deep_right with --ast-dump=json)"
+  echo "9) Run all tests"
+  echo "q) Quit"
+}
+
+function run_all_tests {
+  run_scaling_test "long_block" gen_long_block 1000000
+  run_scaling_test "many_functions" gen_many_functions 100000
+  run_parallel_test 100000
+  run_scaling_test "deep_left" gen_deep_left 1000000
+  run_scaling_test "deep_right" gen_deep_right 1000000
+  run_scaling_test "unary_chain" gen_unary_chain 1000000
+  run_scaling_test "dump_tree" gen_deep_left 1000000 --ast-dump=tree
+  run_scaling_test "dump_json" gen_deep_right 1000000 --ast-dump=json
+}
+
+while true; do
+  list_options
+  read -p "Enter your choice: " choice
+  case $choice in
+    1) run_scaling_test "long_block" gen_long_block 1000000 ;;
+    2) run_scaling_test "many_functions" gen_many_functions 100000 ;;
+    3) run_parallel_test 100000 ;;
+    4) run_scaling_test "deep_left" gen_deep_left 1000000 ;;
+    5) run_scaling_test "deep_right" gen_deep_right 1000000 ;;
+    6) run_scaling_test "unary_chain" gen_unary_chain 1000000 ;;
+    7) run_scaling_test "dump_tree" gen_deep_left 1000000 --ast-dump=tree ;;
+    8) run_scaling_test "dump_json" gen_deep_right 1000000 --ast-dump=json ;;
+    9) run_all_tests ;;
+    q) echo "Exiting."; exit 0 ;;
+    *) echo "Invalid choice. Please try again." ;;
+  esac
+done
@@ -19,6 +19,11 @@ make clean
 make -j mccomp
 
 COMP=$DIR/mccomp
+# Extra mccomp flags for every test, e.g. MCFLAGS=-O2 to check the optimized code
+MCFLAGS=${MCFLAGS:-}
+# MCLINK=1 has mccomp link each program itself with its embedded lld (--link)
+# instead of handing its IR to clang
+MCLINK=${MCLINK:-}
 echo $COMP
 
 function validate {
@@ -36,9 +41,15 @@ function run_test {
 
   cd $test_dir
   pwd
-  rm -rf output.ll $test_exec
-  "$COMP" ./$test_name.c
-  $CLANG driver.cpp output.ll -o $test_exec
+  if [[ -n $MCLINK ]]; then
+    rm -rf driver.o $test_exec
+    $CLANG -c driver.cpp -o driver.o
+    "$COMP" $MCFLAGS ./$test_name.c --link=driver.o -o $test_exec
+  else
+    rm -rf output.ll $test_exec
+    "$COMP" $MCFLAGS ./$test_name.c
+    $CLANG driver.cpp output.ll -o $test_exec
+  fi
   validate "./$test_exec"
   cd $DIR
 }
@@ -0,0 +1,522 @@
+// Grammar table generator.
+//
+// Usage: grammar_gen grammar.txt grammar_sets.h ll1_table.h first_sets.txt follow_sets.txt
+//
+// Reads the MiniC grammar, computes FIRST and FOLLOW for every nonterminal,
+// checks that the grammar is LL(1) and writes:
+//   - grammar_sets.h: a constexpr TokenSet FIRST_x / FOLLOW_x for every
+//     nonterminal x (a trailing ' becomes _prime), for the parser;
+//   - ll1_table.h: the productions with their semantic actions and the LL(1)
+//     parse table, for the table-driven parser in src/ll1_parser.cpp;
+//   - first_sets.txt / follow_sets.txt: the same sets in readable form.
+// Exits with status 1 and a list of conflicts if the grammar is not LL(1).
+//
+// Grammar syntax: "lhs ::= alt | alt ...", where an alternative is a sequence of
+// nonterminals, quoted terminals, upper-case token classes and ( ... | ... )
+// groups; epsilon is the empty alternative and lines starting with # are comments.
+// An @name item is a semantic action: it matches nothing, and the table-driven
+// parser runs hook ACTION_name when it reaches that point of the alternative.
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Terminal spellings as written in grammar.txt, and the TOKEN_TYPE each lexes to
+static const std::map<std::string, std::string> TerminalTokens = {
+    {"\"extern\"", "EXTERN"}, {"\"void\"", "VOID_TOK"}, {"\"int\"", "INT_TOK"},
+    {"\"float\"", "FLOAT_TOK"}, {"\"bool\"", "BOOL_TOK"}, {"\"if\"", "IF"},
+    {"\"else\"", "ELSE"}, {"\"while\"", "WHILE"}, {"\"return\"", "RETURN"},
+    {"\"(\"", "LPAR"}, {"\")\"", "RPAR"}, {"\"{\"", "LBRA"}, {"\"}\"", "RBRA"},
+    {"\";\"", "SC"}, {"\",\"", "COMMA"}, {"\"=\"", "ASSIGN"}, {"\"||\"", "OR"},
+    {"\"&&\"", "AND"}, {"\"==\"", "EQ"}, {"\"!=\"", "NE"}, {"\"<=\"", "LE"},
+    {"\"<\"", "LT"}, {"\">=\"", "GE"}, {"\">\"", "GT"}, {"\"+\"", "PLUS"},
+    {"\"-\"", "MINUS"}, {"\"*\"", "ASTERIX"}, {"\"/\"", "DIV"}, {"\"%\"", "MOD"},
+    {"\"!\"", "NOT"}, {"IDENT", "IDENT"}, {"INT_LIT", "INT_LIT"},
+    {"FLOAT_LIT", "FLOAT_LIT"}, {"BOOL_LIT", "BOOL_LIT"}, {"$", "EOF_TOK"},
+};
+
+// How the token classes read in diagnostics; other terminals are quoted as written
+static const std::map<std::string, std::string> TerminalDescriptions = {
+    {"IDENT", "identifier"}, {"INT_LIT", "integer literal"}, {"FLOAT_LIT", "float literal"},
+    {"BOOL_LIT", "boolean literal"}, {"$", "end of file"},
+};
+
+static const std::string EndMarker = "$";
+static const std::string Epsilon = "epsilon";
+
+struct Production {
+    std::string lhs;
+    std::vector<std::string> rhs; // empty for epsilon
+    int line;
+    std::vector<std::string> symbols; // rhs with its @actions in place
+};
+
+struct Token {
+    std::string text;
+    int line;
+};
+
+static std::vector<std::string> Nonterminals; // in order of definition
+static std::vector<Production> Productions;
+static std::vector<std::string> Actions; // in order of first use, without the @
+
+[[noreturn]] static void fail(int line, const std::string &msg) {
+    std::cerr << "grammar.txt:" << line << ": error: " << msg << "\n";
+    exit(1);
+}
+
+static std::vector<Token> tokenize(std::istream &in) {
+    std::vector<Token> tokens;
+    std::string text;
+    for (int line = 1; std::getline(in, text); ++line) {
+        size_t i = 0;
+        while (i < text.size()) {
+            char c = text[i];
+            if (isspace(static_cast<unsigned char>(c))) {
+                ++i;
+            } else if (c == '#') {
+                break;
+            } else if (c == '"') {
+                size_t end = text.find('"', i + 1);
+                if (end == std::string::npos)
+                    fail(line, "unterminated terminal");
+                tokens.push_back({text.substr(i, end - i + 1), line});
+                i = end + 1;
+            } else if (text.compare(i, 3, "::=") == 0) {
+                tokens.push_back({"::=", line});
+                i += 3;
+            } else if (c == '|' || c == '(' || c == ')') {
+                tokens.push_back({std::string(1, c), line});
+                ++i;
+            } else if (isalpha(static_cast<unsigned char>(c)) || c == '_' || c == '@') {
+                size_t end = i + 1;
+                while (end < text.size() &&
+                       (isalnum(static_cast<unsigned char>(text[end])) || text[end] == '_' || text[end] == '\''))
+                    ++end;
+                tokens.push_back({text.substr(i, end - i), line});
+                i = end;
+            } else {
+                fail(line, std::string("unexpected character '") + c + "'");
+            }
+        }
+    }
+    return tokens;
+}
+
+// Recursive-descent reader for the grammar notation. Groups are expanded in
+// place, so every alternative comes out as a flat symbol sequence.
+class GrammarReader {
+    const std::vector<Token> &tokens;
+    size_t pos = 0;
+
+    bool atRuleStart() const {
+        return pos + 1 < tokens.size() && tokens[pos + 1].text == "::=";
+    }
+    bool atEnd() const { return pos >= tokens.size(); }
+
+    // alternatives ::= sequence ("|" sequence)*
+    std::vector<std::vector<std::string>> alternatives() {
+        std::vector<std::vector<std::string>> alts = sequence();
+        while (!atEnd() && tokens[pos].text == "|") {
+            ++pos;
+            for (auto &alt : sequence())
+                alts.push_back(std::move(alt));
+        }
+        return alts;
+    }
+
+    // sequence ::= item*, as the cross product of each item's alternatives
+    std::vector<std::vector<std::string>> sequence() {
+        std::vector<std::vector<std::string>> seqs = {{}};
+        while (!atEnd() && !atRuleStart() && tokens[pos].text != "|" && tokens[pos].text != ")") {
+            std::vector<std::vector<std::string>> item;
+            if (tokens[pos].text == "(") {
+                int line = tokens[pos++].line;
+                item = alternatives();
+                if (atEnd() || tokens[pos].text != ")")
+                    fail(line, "unclosed '('");
+                ++pos;
+            } else if (tokens[pos].text == Epsilon) {
+                ++pos;
+                item = {{}};
+            } else {
+                item = {{tokens[pos++].text}};
+            }
+
+            std::vector<std::vector<std::string>> product;
+            for (const auto &prefix : seqs) {
+                for (const auto &suffix : item) {
+                    product.push_back(prefix);
+                    product.back().insert(product.back().end(), suffix.begin(), suffix.end());
+                }
+            }
+            seqs = std::move(product);
+        }
+        return seqs;
+    }
+
+public:
+    explicit GrammarReader(const std::vector<Token> &tokens) : tokens(tokens) {}
+
+    void read() {
+        while (!atEnd()) {
+            if (!atRuleStart())
+                fail(tokens[pos].line, "expected 'name ::=' but found '" + tokens[pos].text + "'");
+            const Token &lhs = tokens[pos];
+            pos += 2;
+            if (std::find(Nonterminals.begin(), Nonterminals.end(), lhs.text) != Nonterminals.end())
+                fail(lhs.line, "'" + lhs.text + "' is defined twice");
+            Nonterminals.push_back(lhs.text);
+            for (auto &alt : alternatives()) {
+                Production p{lhs.text, {}, lhs.line, std::move(alt)};
+                for (const std::string &sym : p.symbols) {
+                    if (sym[0] != '@')
+                        p.rhs.push_back(sym);
+                    else if (std::find(Actions.begin(), Actions.end(), sym.substr(1)) == Actions.end())
+                        Actions.push_back(sym.substr(1));
+                }
+                Productions.push_back(std::move(p));
+            }
+            if (!atEnd() && !atRuleStart())
+                fail(tokens[pos].line, "unexpected '" + tokens[pos].text + "'");
+        }
+    }
+};
+
+static bool isNonterminal(const std::string &sym) {
+    return std::find(Nonterminals.begin(), Nonterminals.end(), sym) != Nonterminals.end();
+}
+
+using SymbolSet = std::set<std::string>;
+
+static std::map<std::string, SymbolSet> First;
+static std::map<std::string, SymbolSet> Follow;
+static std::set<std::string> Nullable;
+
+// FIRST of a symbol sequence; *nullable says whether it derives epsilon
+static SymbolSet firstOf(const std::vector<std::string> &seq, size_t from, bool *nullable) {
+    SymbolSet result;
+    for (size_t i = from; i < seq.size(); ++i) {
+        if (!isNonterminal(seq[i])) {
+            result.insert(seq[i]);
+            *nullable = false;
+            return result;
+        }
+        result.insert(First[seq[i]].begin(), First[seq[i]].end());
+        if (!Nullable.count(seq[i])) {
+            *nullable = false;
+            return result;
+        }
+    }
+    *nullable = true;
+    return result;
+}
+
+static void computeSets() {
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const Production &p : Productions) {
+            bool nullable;
+            SymbolSet first = firstOf(p.rhs, 0, &nullable);
+            SymbolSet &target = First[p.lhs];
+            size_t before = target.size();
+            target.insert(first.begin(), first.end());
+            changed |= target.size() != before;
+            if (nullable && Nullable.insert(p.lhs).second)
+                changed = true;
+        }
+    }
+
+    Follow[Nonterminals.front()].insert(EndMarker);
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (const Production &p : Productions) {
+            for (size_t i = 0; i < p.rhs.size(); ++i) {
+                if (!isNonterminal(p.rhs[i]))
+                    continue;
+                bool restNullable;
+                SymbolSet follow = firstOf(p.rhs, i + 1, &restNullable);
+                if (restNullable)
+                    follow.insert(Follow[p.lhs].begin(), Follow[p.lhs].end());
+                SymbolSet &target = Follow[p.rhs[i]];
+                size_t before = target.size();
+                target.insert(follow.begin(), follow.end());
+                changed |= target.size() != before;
+            }
+        }
+    }
+}
+
+static std::string display(const std::string &sym) {
+    if (sym.size() >= 2 && sym.front() == '"')
+        return sym.substr(1, sym.size() - 2);
+    return sym;
+}
+
+static std::string displayAlternative(const Production &p) {
+    if (p.rhs.empty())
+        return Epsilon;
+    std::string out;
+    for (const std::string &sym : p.rhs)
+        out += (out.empty() ? "" : " ") + sym;
+    return out;
+}
+
+// Two alternatives of one nonterminal conflict if their predict sets overlap
+static bool checkLL1() {
+    bool ok = true;
+    for (const std::string &nt : Nonterminals) {
+        std::vector<std::pair<const Production *, SymbolSet>> predicts;
+        for (const Production &p : Productions) {
+            if (p.lhs != nt)
+                continue;
+            bool nullable;
+            SymbolSet predict = firstOf(p.rhs, 0, &nullable);
+            if (nullable)
+                predict.insert(Follow[nt].begin(), Follow[nt].end());
+            for (const auto &[other, otherPredict] : predicts) {
+                for (const std::string &sym : predict) {
+                    if (!otherPredict.count(sym))
+                        continue;
+                    std::cerr << "grammar.txt:" << p.line << ": error: LL(1) conflict in '" << nt
+                              << "' on " << display(sym) << " between '" << displayAlternative(*other)
+                              << "' and '" << displayAlternative(p) << "'\n";
+                    ok = false;
+                }
+            }
+            predicts.push_back({&p, std::move(predict)});
+        }
+    }
+    return ok;
+}
+
+// Set listing in the style of first_sets.txt: ASCII order, epsilon last
+static std::string formatSet(const SymbolSet &set, bool withEpsilon) {
+    std::vector<std::string> items;
+    for (const std::string &sym : set)
+        items.push_back(display(sym));
+    std::sort(items.begin(), items.end());
+    if (withEpsilon)
+        items.push_back("ϵ");
+    std::string out = "{";
+    for (size_t i = 0; i < items.size(); ++i)
+        out += (i ? ", " : "") + items[i];
+    return out + "}";
+}
+
+static std::string identifierFor(const std::string &nt) {
+    std::string id;
+    for (char c : nt)
+        id += c == '\'' ? "_prime" : std::string(1, c);
+    return id;
+}
+
+static std::string tokenList(const SymbolSet &set) {
+    std::vector<std::string> names;
+    for (const std::string &sym : set)
+        names.push_back(TerminalTokens.at(sym));
+    std::sort(names.begin(), names.end());
+    std::string out;
+    for (const std::string &name : names)
+        out += (out.empty() ? "" : ", ") + name;
+    return out;
+}
+
+// How a terminal reads in the parser's diagnostics
+static std::string describeTerminal(const std::string &sym) {
+    auto it = TerminalDescriptions.find(sym);
+    if (it != TerminalDescriptions.end())
+        return it->second;
+    return "'" + display(sym) + "'";
+}
+
+static std::string displaySymbols(const Production &p) {
+    std::string out;
+    for (const std::string &sym : p.symbols)
+        out += " " + sym;
+    return out.empty() ? " " + Epsilon : out;
+}
+
+// Parse stack encoding of a grammar symbol, matching the constants in ll1_table.h
+static std::string encodeSymbol(const std::string &sym) {
+    if (sym[0] == '@')
+        return "LL1ActionBase + ACTION_" + sym.substr(1);
+    if (isNonterminal(sym))
+        return "LL1NonterminalBase + NT_" + identifierFor(sym);
+    return TerminalTokens.at(sym) + " + 128";
+}
+
+static std::string generateTable() {
+    std::string out =
+        "// Generated by tools/grammar_gen.cpp from grammar.txt. Do not edit.\n"
+        "#ifndef LL1_TABLE_H\n"
+        "#define LL1_TABLE_H\n\n"
+        "#include \"tokens.h\"\n"
+        "#include <array>\n"
+        "#include <cstdint>\n\n";
+
+    out += "enum LL1Nonterminal : uint8_t {\n";
+    for (const std::string &nt : Nonterminals)
+        out += "    NT_" + identifierFor(nt) + ",\n";
+    out += "    NumLL1Nonterminals\n};\n\n";
+
+    out += "enum LL1Action : uint8_t {\n";
+    for (const std::string &action : Actions)
+        out += "    ACTION_" + action + ",\n";
+    out += "    NumLL1Actions\n};\n\n";
+
+    out += "inline constexpr const char *LL1NonterminalNames[] = {\n";
+    for (const std::string &nt : Nonterminals)
+        out += "    \"" + nt + "\",\n";
+    out += "};\n\n";
+
+    out += "// Parse stack symbols: token type + 128 for a terminal, LL1NonterminalBase + n\n"
+           "// for nonterminal n and LL1ActionBase + a for action a\n"
+           "inline constexpr int16_t LL1NonterminalBase = 256;\n"
+           "inline constexpr int16_t LL1ActionBase = 512;\n\n";
+
+    // Each right-hand side is stored reversed, so pushing it in array order
+    // leaves its first symbol on top of the parse stack
+    out += "inline constexpr int16_t LL1Symbols[] = {\n";
+    std::string ranges;
+    size_t offset = 0;
+    for (size_t i = 0; i < Productions.size(); ++i) {
+        const Production &p = Productions[i];
+        out += "    // " + std::to_string(i) + ": " + p.lhs + " ::=" + displaySymbols(p) + "\n";
+        for (auto it = p.symbols.rbegin(); it != p.symbols.rend(); ++it)
+            out += "    " + encodeSymbol(*it) + ",\n";
+        ranges += "    {" + std::to_string(offset) + ", " + std::to_string(offset + p.symbols.size()) + "},\n";
+        offset += p.symbols.size();
+    }
+    if (offset == 0)
+        out += "    0,\n";
+    out += "};\n\n";
+
+    out += "// Slice of LL1Symbols holding one production's reversed right-hand side\n"
+           "struct LL1Production {\n"
+           "    uint16_t begin;\n"
+           "    uint16_t end;\n"
+           "};\n\n"
+           "inline constexpr LL1Production LL1Productions[] = {\n" + ranges + "};\n\n";
+
+    out += "inline constexpr uint8_t LL1NoProduction = 255;\n\n"
+           "struct LL1TableEntry {\n"
+           "    LL1Nonterminal nonterminal;\n"
+           "    int token;\n"
+           "    uint8_t production;\n"
+           "};\n\n"
+           "using LL1ParseTable = std::array<std::array<uint8_t, 256>, NumLL1Nonterminals>;\n\n"
+           "constexpr LL1ParseTable makeLL1Table() {\n"
+           "    constexpr LL1TableEntry entries[] = {\n";
+    for (size_t i = 0; i < Productions.size(); ++i) {
+        const Production &p = Productions[i];
+        bool nullable;
+        SymbolSet predict = firstOf(p.rhs, 0, &nullable);
+        if (nullable)
+            predict.insert(Follow[p.lhs].begin(), Follow[p.lhs].end());
+        for (const std::string &sym : predict)
+            out += "        {NT_" + identifierFor(p.lhs) + ", " + TerminalTokens.at(sym) + ", " + std::to_string(i) + "},\n";
+    }
+    out += "    };\n"
+           "    LL1ParseTable table{};\n"
+           "    for (auto &row : table)\n"
+           "        for (uint8_t &cell : row)\n"
+           "            cell = LL1NoProduction;\n"
+           "    for (const LL1TableEntry &e : entries)\n"
+           "        table[e.nonterminal][e.token + 128] = e.production;\n"
+           "    return table;\n"
+           "}\n\n"
+           "// Production to expand for a nonterminal, indexed by [nonterminal][token type + 128]\n"
+           "inline constexpr LL1ParseTable LL1Table = makeLL1Table();\n\n";
+
+    out += "// How a terminal reads in diagnostics\n"
+           "constexpr const char *ll1TerminalSpelling(int tokenType) {\n"
+           "    switch (tokenType) {\n";
+    std::set<std::string> used;
+    for (const Production &p : Productions)
+        for (const std::string &sym : p.rhs)
+            if (!isNonterminal(sym))
+                used.insert(sym);
+    used.insert(EndMarker);
+    for (const std::string &sym : used) {
+        std::string spelling = describeTerminal(sym);
+        std::string escaped;
+        for (char c : spelling)
+            escaped += c == '"' || c == '\\' ? std::string("\\") + c : std::string(1, c);
+        out += "    case " + TerminalTokens.at(sym) + ":\n        return \"" + escaped + "\";\n";
+    }
+    out += "    }\n"
+           "    return \"token\";\n"
+           "}\n\n"
+           "#endif\n";
+    return out;
+}
+
+static void writeFile(const std::string &path, const std::string &contents) {
+    std::ofstream out(path, std::ios::binary);
+    out << contents;
+    if (!out) {
+        std::cerr << "grammar_gen: cannot write " << path << "\n";
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc != 6) {
+        std::cerr << "Usage: grammar_gen grammar.txt grammar_sets.h ll1_table.h first_sets.txt follow_sets.txt\n";
+        return 1;
+    }
+    std::ifstream in(argv[1]);
+    if (!in) {
+        std::cerr << "grammar_gen: cannot read " << argv[1] << "\n";
+        return 1;
+    }
+
+    std::vector<Token> tokens = tokenize(in);
+    GrammarReader(tokens).read();
+    if (Nonterminals.empty())
+        fail(1, "no rules");
+
+    for (const Production &p : Productions)
+        for (const std::string &sym : p.rhs)
+            if (!isNonterminal(sym) && !TerminalTokens.count(sym))
+                fail(p.line, "'" + sym + "' is neither a rule nor a known terminal");
+    for (const std::string &action : Actions)
+        if (action.empty())
+            fail(1, "'@' without an action name");
+    // LL1NoProduction is 255, and every production index must fit below it
+    if (Productions.size() >= 255)
+        fail(1, "too many productions for the LL(1) table");
+
+    computeSets();
+    if (!checkLL1())
+        return 1;
+
+    std::string header =
+        "// Generated by tools/grammar_gen.cpp from grammar.txt. Do not edit.\n"
+        "#ifndef GRAMMAR_SETS_H\n"
+        "#define GRAMMAR_SETS_H\n\n"
+        "#include \"token_set.h\"\n\n";
+    std::string firstText, followText;
+    for (const std::string &nt : Nonterminals) {
+        std::string id = identifierFor(nt);
+        header += "inline constexpr TokenSet FIRST_" + id + " = makeTokenSet({" + tokenList(First[nt]) + "});\n";
+        header += "inline constexpr TokenSet FOLLOW_" + id + " = makeTokenSet({" + tokenList(Follow[nt]) + "});\n";
+        header += "inline constexpr bool NULLABLE_" + id + " = " + (Nullable.count(nt) ? "true" : "false") + ";\n";
+        firstText += "FIRST(" + nt + ") = " + formatSet(First[nt], Nullable.count(nt)) + "\n";
+        followText += "FOLLOW(" + nt + ") = " + formatSet(Follow[nt], false) + "\n";
+    }
+    header += "\n#endif\n";
+
+    writeFile(argv[2], header);
+    writeFile(argv[3], generateTable());
+    writeFile(argv[4], firstText);
+    writeFile(argv[5], followText);
+    return 0;
+}